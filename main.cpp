@@ -1,6 +1,5 @@
 #include <iostream>
 #include <vector>
-#include <unordered_set>
 #include <set>
 #include <fstream>
 #include <stdexcept>
@@ -8,28 +7,352 @@
 #include <algorithm>
 #include <tuple>
 #include <unordered_map>
+#include <numeric>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <optional>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <limits>
+#include <exception>
+#include <deque>
+#include <array>
+#include <cstdio>
+#include <cerrno>
+#include <utility>
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
-// Предоставляет глобальный генератор случайных чисел для единообразной рандомизации.
-// Обеспечивает потокобезопасную инициализацию с использованием статического экземпляра.
-// Возвращает: Ссылку на генератор Mersenne Twister.
+// Подсчет динамических выделений памяти для режима --benchmark (замена глобального operator new).
+// Включается сборкой с -DQUASIGROUP_TRACK_ALLOCATIONS=1; без нее operator new не заменяется, а столбцы
+// выделений в --benchmark пусты.
+#ifndef QUASIGROUP_TRACK_ALLOCATIONS
+#define QUASIGROUP_TRACK_ALLOCATIONS 0
+#endif
+
+static std::atomic<unsigned long long> allocationCount{0}; // Число вызовов operator new.
+static std::atomic<unsigned long long> allocatedBytes{0};  // Суммарный запрошенный объем в байтах.
+
+#if QUASIGROUP_TRACK_ALLOCATIONS
+#if defined(__GNUC__)
+// Без встраивания GCC видит пару malloc/free за operator new/delete и выдает ложное -Wmismatched-new-delete.
+#define QUASIGROUP_NOINLINE __attribute__((noinline))
+#else
+#define QUASIGROUP_NOINLINE
+#endif
+
+QUASIGROUP_NOINLINE void *operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    while (true)
+    {
+        if (void *memory = std::malloc(size == 0 ? 1 : size))
+        {
+            return memory;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler)
+        {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+QUASIGROUP_NOINLINE void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+QUASIGROUP_NOINLINE void operator delete(void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+#endif
+
+// Счетчики горячих путей и время фаз пакетного режима, выгружаемые в JSON (--counters-out) для профилирования
+// без perf. Включаются сборкой с -DQUASIGROUP_ENABLE_COUNTERS=1; без нее макросы ниже раскрываются в пустоту.
+#ifndef QUASIGROUP_ENABLE_COUNTERS
+#define QUASIGROUP_ENABLE_COUNTERS 0
+#endif
+
+#if QUASIGROUP_ENABLE_COUNTERS
+// Фазы, время которых измеряется. При --jobs время суммируется по потокам.
+enum class BatchPhase
+{
+    read,     // Чтение таблиц из корпуса (ожидание фонового чтения).
+    generate, // Генерация таблиц.
+    validate, // Проверка латинского квадрата.
+    analyze,  // Проверки подквазигрупп.
+    write,    // Запись результатов и корпуса.
+    count
+};
+
+const char *const batchPhaseNames[] = {"read", "generate", "validate", "analyze", "write"};
+
+// Счетчики процесса. Горячие циклы добавляют значения не чаще одного раза за проход замыкания или шаг обхода.
+struct PerformanceCounters
+{
+    static constexpr int histogramSize = 32;
+
+    std::atomic<unsigned long long> closureCalls{0};       // Вызовы SubquasigroupClosureEngine::close.
+    std::atomic<unsigned long long> closurePasses{0};      // Проходы замыкания: новый элемент на все имеющиеся.
+    std::atomic<unsigned long long> productsEvaluated{0};  // Вычисленные произведения в замыканиях.
+    std::atomic<unsigned long long> sizeLimitExits{0};     // Замыкания, прерванные пределом размера (order / 2).
+    std::atomic<unsigned long long> squaringWalkSteps{0};  // Шаги обхода циклов возведения в квадрат.
+    std::atomic<unsigned long long> replacementChains{0};  // Цепочки замен makeElementAvailable.
+    std::atomic<unsigned long long> replacementChainSteps{0};
+    std::atomic<unsigned long long> longestReplacementChain{0};
+    std::atomic<unsigned long long> replacementChainHistogram[histogramSize] = {}; // Корзина b: длина в [2^b, 2^(b+1)).
+    std::atomic<unsigned long long> phaseNanoseconds[static_cast<int>(BatchPhase::count)] = {};
+
+    void recordReplacementChain(unsigned long long length)
+    {
+        replacementChains.fetch_add(1, std::memory_order_relaxed);
+        replacementChainSteps.fetch_add(length, std::memory_order_relaxed);
+        unsigned long long longest = longestReplacementChain.load(std::memory_order_relaxed);
+        while (length > longest && !longestReplacementChain.compare_exchange_weak(longest, length, std::memory_order_relaxed))
+        {
+        }
+        int bucket = std::min(63 - __builtin_clzll(length), histogramSize - 1);
+        replacementChainHistogram[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+static PerformanceCounters performanceCounters;
+
+// Добавляет ко времени фазы время жизни объекта.
+class ScopedPhaseTimer
+{
+    BatchPhase phase;
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+public:
+    explicit ScopedPhaseTimer(BatchPhase phase) : phase(phase) {}
+    ScopedPhaseTimer(const ScopedPhaseTimer &) = delete;
+    ScopedPhaseTimer &operator=(const ScopedPhaseTimer &) = delete;
+    ~ScopedPhaseTimer()
+    {
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime);
+        performanceCounters.phaseNanoseconds[static_cast<int>(phase)].fetch_add(
+            static_cast<unsigned long long>(elapsed.count()), std::memory_order_relaxed);
+    }
+};
+
+// Записывает счетчики в поток как объект JSON.
+// Параметр stream: Поток вывода.
+void writePerformanceCountersJson(std::ostream &stream)
+{
+    auto value = [](const std::atomic<unsigned long long> &counter) { return counter.load(std::memory_order_relaxed); };
+    const PerformanceCounters &counters = performanceCounters;
+    stream << "{\n"
+           << "  \"closure_calls\": " << value(counters.closureCalls) << ",\n"
+           << "  \"closure_passes\": " << value(counters.closurePasses) << ",\n"
+           << "  \"products_evaluated\": " << value(counters.productsEvaluated) << ",\n"
+           << "  \"size_limit_exits\": " << value(counters.sizeLimitExits) << ",\n"
+           << "  \"squaring_walk_steps\": " << value(counters.squaringWalkSteps) << ",\n"
+           << "  \"replacement_chains\": " << value(counters.replacementChains) << ",\n"
+           << "  \"replacement_chain_steps\": " << value(counters.replacementChainSteps) << ",\n"
+           << "  \"longest_replacement_chain\": " << value(counters.longestReplacementChain) << ",\n"
+           << "  \"replacement_chain_histogram\": [";
+    int lastBucket = PerformanceCounters::histogramSize - 1;
+    while (lastBucket > 0 && value(counters.replacementChainHistogram[lastBucket]) == 0)
+    {
+        --lastBucket;
+    }
+    for (int bucket = 0; bucket <= lastBucket; ++bucket)
+    {
+        stream << (bucket ? ", " : "") << value(counters.replacementChainHistogram[bucket]);
+    }
+    stream << "],\n  \"phase_seconds\": {";
+    for (int phase = 0; phase < static_cast<int>(BatchPhase::count); ++phase)
+    {
+        stream << (phase ? ", " : "") << '"' << batchPhaseNames[phase] << "\": "
+               << static_cast<double>(value(counters.phaseNanoseconds[phase])) / 1e9;
+    }
+    stream << "}\n}\n";
+}
+
+#define QUASIGROUP_COUNT(counter, amount) \
+    performanceCounters.counter.fetch_add(static_cast<unsigned long long>(amount), std::memory_order_relaxed)
+#define QUASIGROUP_RECORD_REPLACEMENT_CHAIN(length) performanceCounters.recordReplacementChain(length)
+#define QUASIGROUP_CONCATENATE_IMPL(first, second) first##second
+#define QUASIGROUP_CONCATENATE(first, second) QUASIGROUP_CONCATENATE_IMPL(first, second)
+#define QUASIGROUP_TIME_PHASE(phase) ScopedPhaseTimer QUASIGROUP_CONCATENATE(phaseTimer, __LINE__)(BatchPhase::phase)
+#else
+#define QUASIGROUP_COUNT(counter, amount) ((void)0)
+#define QUASIGROUP_RECORD_REPLACEMENT_CHAIN(length) ((void)0)
+#define QUASIGROUP_TIME_PHASE(phase) ((void)0)
+#endif
+
+// Программная подгрузка строки кэша для чтения; без поддержки компилятора ничего не делает.
+#if defined(__GNUC__) || defined(__clang__)
+#define QUASIGROUP_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define QUASIGROUP_PREFETCH(address) ((void)(address))
+#endif
+
+// Предоставляет генератор случайных чисел текущего потока для единообразной рандомизации.
+// У каждого потока свой экземпляр, поэтому генераторы таблиц можно запускать параллельно.
+// Возвращает: Ссылку на генератор Mersenne Twister текущего потока.
 static std::mt19937 &getRandomNumberGenerator()
 {
-    static std::mt19937 generator(std::random_device{}());
+    thread_local std::mt19937 generator(std::random_device{}());
     return generator;
 }
 
-// Выбирает случайный элемент из множества, используется в алгоритмах генерации.
-// Шаблонный параметр Set: Контейнер с методами begin(), end(), size() (например, std::unordered_set).
-// Параметр set: Множество для выбора.
-// Возвращает: Случайно выбранный элемент.
+// Переводит генератор текущего потока на поток случайных чисел с номером streamIndex, выведенный из главного
+// зерна через std::seed_seq: пара (masterSeed, streamIndex) всегда дает одну и ту же последовательность,
+// в каком бы потоке она ни использовалась, а разные номера дают независимые на вид последовательности.
+// Параметры:
+//   masterSeed: Главное зерно запуска.
+//   streamIndex: Номер потока, например номер таблицы.
+void seedRandomNumberStream(std::uint64_t masterSeed, std::uint64_t streamIndex)
+{
+    std::seed_seq sequence{static_cast<std::uint32_t>(masterSeed), static_cast<std::uint32_t>(masterSeed >> 32),
+                           static_cast<std::uint32_t>(streamIndex), static_cast<std::uint32_t>(streamIndex >> 32)};
+    getRandomNumberGenerator().seed(sequence);
+}
+
+// Арена временной памяти: выделение сдвигает указатель внутри блока, освобождение — откат к отметке.
+// Блоки не возвращаются системе, поэтому после первых таблиц повторные замыкания и строки генераторов
+// берут память из уже выделенных блоков без malloc и без общей для потоков блокировки кучи.
+// Память выдается только внутри Scope: при выходе из него все выделенное после его начала освобождается разом.
+class ScratchArena
+{
+    struct Block
+    {
+        std::unique_ptr<std::byte[]> memory;
+        std::size_t size;
+    };
+
+    std::vector<Block> blocks;
+    std::size_t blockIndex = 0; // Текущий блок.
+    std::size_t offset = 0;     // Занятая часть текущего блока.
+
+public:
+    static constexpr std::size_t minimumBlockSize = std::size_t(64) << 10;
+
+    // Отмечает состояние арены при создании и возвращает ее к нему при уничтожении. Области вложены как
+    // области видимости: внутренняя закрывается раньше внешней.
+    class Scope
+    {
+        ScratchArena &arena;
+        std::size_t savedBlockIndex, savedOffset;
+
+    public:
+        explicit Scope(ScratchArena &arena) : arena(arena), savedBlockIndex(arena.blockIndex), savedOffset(arena.offset) {}
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+        ~Scope()
+        {
+            arena.blockIndex = savedBlockIndex;
+            arena.offset = savedOffset;
+        }
+    };
+
+    // Выделяет size байт с выравниванием alignment (не больше alignof(std::max_align_t)).
+    void *allocate(std::size_t size, std::size_t alignment)
+    {
+        while (blockIndex < blocks.size())
+        {
+            std::size_t alignedOffset = (offset + alignment - 1) & ~(alignment - 1);
+            if (alignedOffset + size <= blocks[blockIndex].size)
+            {
+                offset = alignedOffset + size;
+                return blocks[blockIndex].memory.get() + alignedOffset;
+            }
+            ++blockIndex;
+            offset = 0;
+        }
+        std::size_t blockSize = std::max({minimumBlockSize, blocks.empty() ? 0 : 2 * blocks.back().size, size});
+        blocks.push_back({std::make_unique<std::byte[]>(blockSize), blockSize});
+        blockIndex = blocks.size() - 1;
+        offset = size;
+        return blocks.back().memory.get();
+    }
+};
+
+// Возвращает: Арену временной памяти текущего потока.
+static ScratchArena &getThreadScratchArena()
+{
+    thread_local ScratchArena arena;
+    return arena;
+}
+
+// Аллокатор контейнеров поверх ScratchArena; deallocate ничего не делает, память освобождает Scope.
+// Шаблонный параметр T: Тип элементов.
+template <class T>
+struct ScratchAllocator
+{
+    using value_type = T;
+
+    ScratchArena *arena;
+
+    ScratchAllocator(ScratchArena &arena) : arena(&arena) {}
+    template <class Other>
+    ScratchAllocator(const ScratchAllocator<Other> &other) : arena(other.arena) {}
+
+    T *allocate(std::size_t count) { return static_cast<T *>(arena->allocate(count * sizeof(T), alignof(T))); }
+    void deallocate(T *, std::size_t) {}
+
+    template <class Other>
+    bool operator==(const ScratchAllocator<Other> &other) const { return arena == other.arena; }
+    template <class Other>
+    bool operator!=(const ScratchAllocator<Other> &other) const { return arena != other.arena; }
+};
+
+// Вектор во временной памяти; должен быть уничтожен до выхода из Scope, в котором создан.
+template <class T>
+using ScratchVector = std::vector<T, ScratchAllocator<T>>;
+
+// Выбирает случайный установленный бит битового множества, используется в алгоритмах генерации.
+// Параметры:
+//   words: Битовое множество из 64-битных слов.
+//   wordCount: Число слов.
+// Возвращает: Номер равновероятно выбранного установленного бита.
+// Порядковый номер бита выбирается по сумме popcount, бит внутри слова — через pdep (BMI2), если доступно.
 // Выбрасывает: Неопределенное поведение, если множество пустое.
-template <class Set>
-auto selectRandomElement(const Set &set)
+static int selectRandomSetBit(const std::uint64_t *words, int wordCount)
 {
-    auto iterator = set.begin();
-    std::uniform_int_distribution<std::size_t> distribution(0, set.size() - 1);
-    std::advance(iterator, distribution(getRandomNumberGenerator()));
-    return *iterator;
+    int bitCount = 0;
+    for (int word = 0; word < wordCount; ++word)
+    {
+        bitCount += __builtin_popcountll(words[word]);
+    }
+    std::uniform_int_distribution<int> distribution(0, bitCount - 1);
+    int rank = distribution(getRandomNumberGenerator());
+    int word = 0;
+    for (int wordBits; rank >= (wordBits = __builtin_popcountll(words[word])); ++word)
+    {
+        rank -= wordBits;
+    }
+#if defined(__BMI2__)
+    return word * 64 + __builtin_ctzll(_pdep_u64(std::uint64_t{1} << rank, words[word]));
+#else
+    std::uint64_t bits = words[word];
+    for (; rank > 0; --rank)
+    {
+        bits &= bits - 1;
+    }
+    return word * 64 + __builtin_ctzll(bits);
+#endif
 }
 
 // Вычисляет наибольший общий делитель (НОД) двух чисел с помощью алгоритма Евклида.
@@ -47,551 +370,6594 @@ int computeGreatestCommonDivisor(int firstNumber, int secondNumber)
     return firstNumber;
 }
 
-// Представляет конечную квазигруппу — алгебраическую структуру с бинарной операцией, образующей латинский квадрат.
-// Хранит таблицу Кэли и предоставляет методы для проверки собственных и нетривиальных подквазигрупп.
-class Quasigroup
+// Пул потоков с перехватом работы (work stealing) для независимых задач с индексами 0..taskCount-1.
+// Каждый поток начинает со своего непрерывного диапазона индексов и берет задачи с его начала;
+// опустевший поток забирает вторую половину оставшегося диапазона у самого загруженного соседа.
+// Вызывающий поток участвует в работе как поток 0, поэтому пул из одного потока не создает потоков.
+// Задача может отменить все оставшиеся задачи, вернув false; флаг отмены доступен задачам через isCancelled().
+// Исключение задачи в любом потоке тоже отменяет запуск; run дожидается всех потоков и выбрасывает первое из них.
+class WorkStealingThreadPool
 {
-    std::vector<std::vector<int>> cayleyTable; // Таблица Кэли, хранящая операцию квазигруппы.
-    int order;                                 // Порядок (размер) квазигруппы.
+    struct alignas(64) WorkerRange
+    {
+        std::mutex mutex;
+        std::size_t next = 0; // Следующая задача владельца.
+        std::size_t end = 0;  // Граница диапазона (не включительно).
+    };
+
+    unsigned workerCount;                       // Число потоков, включая вызывающий.
+    std::unique_ptr<WorkerRange[]> ranges;      // Диапазоны задач потоков.
+    std::vector<std::thread> threads;           // Фоновые потоки 1..workerCount-1.
+    std::function<bool(std::size_t, unsigned)> task; // Текущая задача: task(index, worker).
+    std::atomic<bool> cancelled{false};         // Флаг досрочной остановки текущего запуска.
+    std::exception_ptr error;                   // Первое исключение задачи текущего запуска (под stateMutex).
+    std::mutex stateMutex;
+    std::condition_variable wakeCondition, doneCondition;
+    std::uint64_t generation = 0; // Номер текущего запуска.
+    unsigned busyWorkers = 0;     // Число фоновых потоков, еще не завершивших запуск.
+    bool shuttingDown = false;
 
 public:
-    // Конструирует квазигруппу из заданной таблицы Кэли.
-    // Параметр cayleyTable: Квадратная матрица, задающая операцию квазигруппы.
-    // Инициализирует порядок на основе размера таблицы.
-    explicit Quasigroup(const std::vector<std::vector<int>> &cayleyTable)
-        : cayleyTable(cayleyTable), order(static_cast<int>(cayleyTable.size())) {}
+    // Параметр workerCount: Число потоков; 0 означает std::thread::hardware_concurrency().
+    explicit WorkStealingThreadPool(unsigned workerCount = 0)
+        : workerCount(std::max(1U, workerCount ? workerCount : std::thread::hardware_concurrency())),
+          ranges(new WorkerRange[this->workerCount])
+    {
+        for (unsigned worker = 1; worker < this->workerCount; ++worker)
+        {
+            threads.emplace_back([this, worker] { backgroundLoop(worker); });
+        }
+    }
 
-    // Вычисляет результат операции квазигруппы для двух элементов.
-    // Параметры:
-    //   firstElement, secondElement: Индексы элементов (от 0 до order-1).
-    // Возвращает: Результат операции (firstElement * secondElement) из таблицы Кэли.
-    // Выбрасывает: std::out_of_range при некорректных индексах.
-    int applyOperation(int firstElement, int secondElement) const
+    WorkStealingThreadPool(const WorkStealingThreadPool &) = delete;
+    WorkStealingThreadPool &operator=(const WorkStealingThreadPool &) = delete;
+
+    ~WorkStealingThreadPool()
     {
-        if (firstElement >= 0 && firstElement < order && secondElement >= 0 && secondElement < order)
         {
-            return cayleyTable[firstElement][secondElement];
+            std::lock_guard<std::mutex> lock(stateMutex);
+            shuttingDown = true;
+        }
+        wakeCondition.notify_all();
+        for (auto &thread : threads)
+        {
+            thread.join();
         }
-        throw std::out_of_range("Индекс вне диапазона таблицы Кэли");
     }
 
-    // Проверяет наличие подквазигрупп (собственных или нетривиальных).
-    // Параметр checkForProperSubquasigroups:
-    //   - true: Проверяет собственные подквазигруппы (размер < порядок).
-    //   - false: Проверяет нетривиальные подквазигруппы (размер > 1).
-    // Возвращает: true, если подквазигруппа указанного типа существует, false — иначе.
-    // Использует циклический подход для генерации начальных множеств подквазигрупп.
-    bool hasSubquasigroups(bool checkForProperSubquasigroups) const
+    unsigned getWorkerCount() const { return workerCount; }
+    bool isCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+
+    // Выполняет taskCount задач и ждет их завершения.
+    // Параметр newTask: Вызывается как newTask(index, worker); возврат false отменяет оставшиеся задачи.
+    // Возвращает: true, если запуск был отменен задачей.
+    // Выбрасывает: Первое исключение задачи, после того как все потоки закончили запуск.
+    bool run(std::size_t taskCount, std::function<bool(std::size_t, unsigned)> newTask)
     {
-        std::vector<bool> visitedElements(order, false);
-        for (int startElement = 0; startElement < order; ++startElement)
+        task = std::move(newTask);
+        cancelled.store(false, std::memory_order_relaxed);
+        for (unsigned worker = 0; worker < workerCount; ++worker)
+        {
+            std::lock_guard<std::mutex> lock(ranges[worker].mutex);
+            ranges[worker].next = taskCount * worker / workerCount;
+            ranges[worker].end = taskCount * (worker + 1) / workerCount;
+        }
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            busyWorkers = workerCount - 1;
+            ++generation;
+        }
+        wakeCondition.notify_all();
+        processTasks(0);
+        std::unique_lock<std::mutex> lock(stateMutex);
+        doneCondition.wait(lock, [this] { return busyWorkers == 0; });
+        task = nullptr;
+        if (error)
+        {
+            std::rethrow_exception(std::exchange(error, nullptr));
+        }
+        return isCancelled();
+    }
+
+private:
+    void backgroundLoop(unsigned worker)
+    {
+        std::uint64_t seenGeneration = 0;
+        while (true)
         {
-            if (!visitedElements[startElement])
             {
-                std::unordered_set<int> cycleElements;
-                int currentElement = startElement;
-                while (cycleElements.insert(currentElement).second)
-                {
-                    visitedElements[currentElement] = true;
-                    currentElement = applyOperation(currentElement, currentElement);
-                }
-                if (checkForProperSubquasigroups)
-                {
-                    if (verifyProperSubquasigroup(cycleElements))
-                    {
-                        return true;
-                    }
-                }
-                else
+                std::unique_lock<std::mutex> lock(stateMutex);
+                wakeCondition.wait(lock, [&] { return shuttingDown || generation != seenGeneration; });
+                if (shuttingDown)
                 {
-                    if (verifyNonTrivialSubquasigroup(cycleElements))
-                    {
-                        return true;
-                    }
+                    return;
                 }
+                seenGeneration = generation;
+            }
+            processTasks(worker);
+            {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                --busyWorkers;
             }
+            doneCondition.notify_one();
         }
-        return false;
     }
 
-private:
-    // Проверяет, порождает ли начальное множество собственную подквазигруппу (размер < порядок).
-    // Параметр seedSet: Начальное множество элементов для проверки замыкания.
-    // Возвращает: true, если порожденное множество — собственная подквазигруппа, false — иначе.
-    // Итеративно замыкает множество под операцией, останавливаясь при размере > порядок/2.
-    bool verifyProperSubquasigroup(const std::unordered_set<int> &seedSet) const
+    void processTasks(unsigned worker)
     {
-        auto closedSet = seedSet;
-        bool setChanged = true;
-        while (setChanged)
+        std::size_t index;
+        while (!isCancelled() && (takeOwnTask(worker, index) || stealTask(worker, index)))
         {
-            setChanged = false;
-            std::vector<int> currentElements(closedSet.begin(), closedSet.end());
-            for (int firstElement : currentElements)
+            try
             {
-                for (int secondElement : currentElements)
+                if (!task(index, worker))
                 {
-                    int result = applyOperation(firstElement, secondElement);
-                    if (closedSet.insert(result).second)
-                    {
-                        setChanged = true;
-                        if (static_cast<int>(closedSet.size()) > order / 2)
-                        {
-                            return false;
-                        }
-                    }
+                    cancelled.store(true, std::memory_order_relaxed);
+                }
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                if (!error)
+                {
+                    error = std::current_exception();
                 }
+                cancelled.store(true, std::memory_order_relaxed);
             }
         }
-        return static_cast<int>(closedSet.size()) < order;
     }
 
-    // Проверяет, порождает ли начальное множество нетривиальную подквазигруппу (размер > 1).
-    // Параметр seedSet: Начальное множество элементов для проверки замыкания.
-    // Возвращает: true, если порожденное множество нетривиально, false — иначе.
-    // Итеративно замыкает множество под операцией квазигруппы.
-    bool verifyNonTrivialSubquasigroup(const std::unordered_set<int> &seedSet) const
+    bool takeOwnTask(unsigned worker, std::size_t &index)
     {
-        auto closedSet = seedSet;
-        if (closedSet.size() == 1)
+        std::lock_guard<std::mutex> lock(ranges[worker].mutex);
+        if (ranges[worker].next >= ranges[worker].end)
         {
             return false;
         }
-        bool setChanged = true;
-        while (setChanged)
+        index = ranges[worker].next++;
+        return true;
+    }
+
+    // Забирает половину диапазона у потока с наибольшим остатком задач.
+    bool stealTask(unsigned thief, std::size_t &index)
+    {
+        while (true)
         {
-            setChanged = false;
-            std::vector<int> currentElements(closedSet.begin(), closedSet.end());
-            for (int firstElement : currentElements)
+            unsigned victim = thief;
+            std::size_t largestRemaining = 0;
+            for (unsigned worker = 0; worker < workerCount; ++worker)
             {
-                for (int secondElement : currentElements)
+                std::lock_guard<std::mutex> lock(ranges[worker].mutex);
+                std::size_t remaining = ranges[worker].end - std::min(ranges[worker].next, ranges[worker].end);
+                if (worker != thief && remaining > largestRemaining)
                 {
-                    int result = applyOperation(firstElement, secondElement);
-                    if (closedSet.insert(result).second)
-                    {
-                        setChanged = true;
-                    }
+                    victim = worker;
+                    largestRemaining = remaining;
+                }
+            }
+            if (victim == thief)
+            {
+                return false;
+            }
+            std::size_t stolenBegin, stolenEnd;
+            {
+                std::lock_guard<std::mutex> lock(ranges[victim].mutex);
+                if (ranges[victim].next >= ranges[victim].end)
+                {
+                    continue;
                 }
+                stolenEnd = ranges[victim].end;
+                stolenBegin = ranges[victim].next + (stolenEnd - ranges[victim].next) / 2;
+                ranges[victim].end = stolenBegin;
             }
+            std::lock_guard<std::mutex> lock(ranges[thief].mutex);
+            index = stolenBegin;
+            ranges[thief].next = stolenBegin + 1;
+            ranges[thief].end = stolenEnd;
+            return true;
         }
-        return static_cast<int>(closedSet.size()) > 1;
     }
 };
 
-// Читает таблицу Кэли из файла для создания квазигруппы.
-// Параметр fileName: Путь к входному файлу.
-// Формат: Первая строка — порядок n, затем n x n целых чисел.
-// Возвращает: Вектор векторов, представляющий таблицу Кэли.
-// Выбрасывает: std::runtime_error, если файл не удалось открыть.
-std::vector<std::vector<int>> readCayleyTableFromFile(const std::string &fileName)
+class CayleyTableView;
+
+// Плоская таблица Кэли: единый построчный буфер вместо вектора векторов.
+// Ширина ячейки выбирается по порядку: до 256 — uint8_t, до 65536 — uint16_t, иначе — uint32_t.
+// Благодаря этому таблица порядка 4096 занимает 32 МиБ вместо 64 МиБ и не разбита на тысячи строк в куче.
+class CayleyTable
 {
-    std::ifstream file(fileName);
-    if (!file)
-    {
-        throw std::runtime_error("Не удалось открыть файл");
-    }
-    int order;
-    file >> order;
-    std::vector<std::vector<int>> cayleyTable(order, std::vector<int>(order));
-    for (int row = 0; row < order; ++row)
+    int order = 0;                 // Порядок (размер) таблицы.
+    int cellWidth = 1;             // Ширина ячейки в байтах (1, 2 или 4).
+    std::shared_ptr<void> storage; // Владелец памяти ячеек.
+    void *cells = nullptr;         // Начало построчного буфера ячеек.
+
+public:
+    CayleyTable() = default;
+
+    // Создает таблицу заданного порядка, заполненную нулями.
+    // Параметр order: Порядок таблицы.
+    // Выбрасывает: std::invalid_argument при отрицательном порядке.
+    explicit CayleyTable(int order) : order(order), cellWidth(selectCellWidth(order))
     {
-        for (int column = 0; column < order; ++column)
+        if (order < 0)
         {
-            file >> cayleyTable[row][column];
+            throw std::invalid_argument("Порядок квазигруппы не может быть отрицательным");
         }
+        storage = std::shared_ptr<void>(::operator new(getByteSize()), [](void *memory) { ::operator delete(memory); });
+        cells = storage.get();
+        std::memset(cells, 0, getByteSize());
     }
-    return cayleyTable;
-}
 
-// Читает таблицу Кэли из стандартного ввода, запрашивая значения у пользователя.
-// Запрашивает порядок и каждый элемент таблицы, проверяя корректность ввода.
-// Возвращает: Вектор векторов, представляющий таблицу Кэли.
-std::vector<std::vector<int>> readCayleyTableFromStandardInput()
-{
-    int order;
-    std::cout << "\nВведите порядок квазигруппы: ";
-    std::cin >> order;
-    std::vector<std::vector<int>> cayleyTable(order, std::vector<int>(order));
-    std::cout << "\nВведите таблицу Кэли (" << order << "x" << order << "):\n";
-    for (int row = 0; row < order; ++row)
+    CayleyTable(const CayleyTable &other) : CayleyTable(other.order)
     {
-        for (int column = 0; column < order; ++column)
+        // У пустой таблицы, созданной конструктором по умолчанию, буфера нет, а memcpy из nullptr не определен.
+        if (other.cells)
         {
-            std::cout << "(" << row << "," << column << "): ";
-            std::cin >> cayleyTable[row][column];
-            while (cayleyTable[row][column] > order - 1)
-            {
-                std::cout << "Элементы должны быть меньше " << order << "\nВведите снова: \n";
-                std::cout << "(" << row << "," << column << "): ";
-                std::cin >> cayleyTable[row][column];
-            }
+            std::memcpy(cells, other.cells, getByteSize());
         }
     }
-    return cayleyTable;
-}
 
-// Генерирует таблицу Кэли для циклической группы порядка n.
-// Операция: x * y = (x + y) mod n.
-// Параметр order: Размер группы.
-// Возвращает: Вектор векторов, представляющий таблицу Кэли.
-std::vector<std::vector<int>> generateCyclicGroupCayleyTable(int order)
-{
-    std::vector<std::vector<int>> cayleyTable(order, std::vector<int>(order));
-    for (int row = 0; row < order; ++row)
+    CayleyTable(CayleyTable &&other) noexcept
+        : order(other.order), cellWidth(other.cellWidth), storage(std::move(other.storage)), cells(other.cells)
     {
-        for (int column = 0; column < order; ++column)
-        {
-            cayleyTable[row][column] = (row + column) % order;
-        }
+        other.order = 0;
+        other.cells = nullptr;
     }
-    return cayleyTable;
-}
-
-// Генерирует случайную перестановку чисел от 0 до n-1.
-// Используется в генерации аффинной квазигруппы для функции f.
-// Параметр order: Размер перестановки.
-// Возвращает: Вектор, представляющий перестановку.
-std::vector<int> generateRandomPermutation(int order)
-{
-    std::vector<int> permutation(order);
-    std::iota(permutation.begin(), permutation.end(), 0);
-    std::shuffle(permutation.begin(), permutation.end(), getRandomNumberGenerator());
-    return permutation;
-}
 
-// Генерирует таблицу Кэли для аффинной квазигруппы.
-// Операция: x * y = (alpha * x + beta * f(y) + c) mod n, где f — перестановка.
-// Параметр order: Размер квазигруппы.
-// Запрашивает alpha, beta (должны быть взаимно простыми с n) и c (0 <= c < n).
-// Возвращает: Вектор векторов, представляющий таблицу Кэли.
-std::vector<std::vector<int>> generateAffineQuasigroupCayleyTable(int order)
-{
-    int coefficientAlpha, coefficientBeta, constantC;
-    std::cout << "Введите коэффициент alpha (должен быть взаимно простым с " << order << "): ";
-    std::cin >> coefficientAlpha;
-    while (computeGreatestCommonDivisor(coefficientAlpha, order) != 1)
+    // Создает таблицу поверх готового буфера без копирования (например, отображенного в память файла).
+    // Параметры:
+    //   order: Порядок таблицы; ширина ячейки равна selectCellWidth(order).
+    //   owner: Владелец памяти, освобождает ее вместе с последней копией указателя.
+    //   cells: Начало построчного буфера внутри памяти owner.
+    // Возвращает: Таблицу, разделяющую память с owner.
+    static CayleyTable adoptStorage(int order, std::shared_ptr<void> owner, void *cells)
     {
-        std::cout << "alpha должен быть взаимно простым с " << order << ". Введите снова: ";
-        std::cin >> coefficientAlpha;
+        CayleyTable table;
+        table.order = order;
+        table.cellWidth = selectCellWidth(order);
+        table.storage = std::move(owner);
+        table.cells = cells;
+        return table;
     }
-    std::cout << "Введите коэффициент beta (должен быть взаимно простым с " << order << "): ";
-    std::cin >> coefficientBeta;
-    while (computeGreatestCommonDivisor(coefficientBeta, order) != 1)
+
+    // Создает таблицу, не владеющую памятью, поверх ячеек представления; копирования нет.
+    // Параметр view: Представление; его таблица должна жить дольше результата и не меняться, пока он используется.
+    // Возвращает: Таблицу для кода, принимающего CayleyTable, например Quasigroup. Писать в нее нельзя.
+    static CayleyTable borrow(const CayleyTableView &view);
+
+    // Готовит таблицу к перезаписи всех ячеек таблицей порядка order. Буфер того же размера, которым таблица
+    // владеет одна, переиспользуется; иначе выделяется новый. Содержимое после вызова не определено.
+    // Параметр order: Порядок таблицы.
+    // Выбрасывает: std::invalid_argument при отрицательном порядке.
+    void assignOrder(int order)
     {
-        std::cout << "beta должен быть взаимно простым с " << order << ". Введите снова: ";
-        std::cin >> coefficientBeta;
+        if (order != this->order || storage.use_count() != 1)
+        {
+            *this = CayleyTable(order);
+        }
     }
-    std::cout << "Введите константу c (0 <= c < " << order << "): ";
-    std::cin >> constantC;
-    while (constantC < 0 || constantC >= order)
+
+    CayleyTable &operator=(CayleyTable other) noexcept
     {
-        std::cout << "c должно быть в диапазоне [0, " << order - 1 << "]. Введите снова: ";
-        std::cin >> constantC;
+        std::swap(order, other.order);
+        std::swap(cellWidth, other.cellWidth);
+        std::swap(storage, other.storage);
+        std::swap(cells, other.cells);
+        return *this;
     }
 
-    auto permutationFunction = generateRandomPermutation(order);
-    std::cout << "Сгенерированная перестановка f: ";
-    for (int value : permutationFunction)
+    // Выбирает минимальную ширину ячейки, в которую помещаются элементы 0..order-1.
+    // Возвращает: Ширину ячейки в байтах.
+    static int selectCellWidth(int order)
     {
-        std::cout << value << ' ';
+        if (order <= 256)
+        {
+            return 1;
+        }
+        return order <= 65536 ? 2 : 4;
     }
-    std::cout << "\n";
 
-    std::vector<std::vector<int>> cayleyTable(order, std::vector<int>(order));
-    for (int row = 0; row < order; ++row)
+    int getOrder() const { return order; }
+    int getCellWidth() const { return cellWidth; }
+    std::size_t getByteSize() const { return static_cast<std::size_t>(order) * order * cellWidth; }
+    const void *data() const { return cells; }
+    void *data() { return cells; }
+
+    // Возвращает значение ячейки (row, column) без проверки границ.
+    int operator()(int row, int column) const
+    {
+        std::size_t index = static_cast<std::size_t>(row) * order + column;
+        switch (cellWidth)
+        {
+        case 1:
+            return static_cast<const std::uint8_t *>(cells)[index];
+        case 2:
+            return static_cast<const std::uint16_t *>(cells)[index];
+        default:
+            return static_cast<int>(static_cast<const std::uint32_t *>(cells)[index]);
+        }
+    }
+
+    // Записывает значение в ячейку (row, column) без проверки границ.
+    void set(int row, int column, int value)
+    {
+        std::size_t index = static_cast<std::size_t>(row) * order + column;
+        switch (cellWidth)
+        {
+        case 1:
+            static_cast<std::uint8_t *>(cells)[index] = static_cast<std::uint8_t>(value);
+            break;
+        case 2:
+            static_cast<std::uint16_t *>(cells)[index] = static_cast<std::uint16_t>(value);
+            break;
+        default:
+            static_cast<std::uint32_t *>(cells)[index] = static_cast<std::uint32_t>(value);
+            break;
+        }
+    }
+
+    // Вызывает visitor с типизированным представлением ячеек (CayleyCells<uint8_t/uint16_t/uint32_t>).
+    // Ширина ячейки разрешается один раз, поэтому горячие циклы внутри visitor не содержат ветвлений по ширине.
+    template <class Visitor>
+    decltype(auto) visitCells(Visitor &&visitor) const;
+
+    // Вариант visitCells для заполнения таблицы: visitor получает MutableCayleyCells.
+    template <class Visitor>
+    decltype(auto) visitMutableCells(Visitor &&visitor);
+};
+
+// Типизированное представление ячеек плоской таблицы для горячих циклов.
+// Шаблонный параметр Cell: Тип ячейки (uint8_t, uint16_t или uint32_t).
+template <class Cell>
+struct CayleyCells
+{
+    const Cell *cells; // Построчный буфер ячеек.
+    int order;         // Порядок таблицы.
+
+    int operator()(int row, int column) const
+    {
+        return static_cast<int>(cells[static_cast<std::size_t>(row) * order + column]);
+    }
+};
+
+// Типизированное представление ячеек с возможностью записи.
+template <class Cell>
+struct MutableCayleyCells
+{
+    Cell *cells; // Построчный буфер ячеек.
+    int order;   // Порядок таблицы.
+
+    int operator()(int row, int column) const
+    {
+        return static_cast<int>(cells[static_cast<std::size_t>(row) * order + column]);
+    }
+
+    void set(int row, int column, int value)
+    {
+        cells[static_cast<std::size_t>(row) * order + column] = static_cast<Cell>(value);
+    }
+};
+
+template <class Visitor>
+decltype(auto) CayleyTable::visitMutableCells(Visitor &&visitor)
+{
+    switch (cellWidth)
+    {
+    case 1:
+        return visitor(MutableCayleyCells<std::uint8_t>{static_cast<std::uint8_t *>(cells), order});
+    case 2:
+        return visitor(MutableCayleyCells<std::uint16_t>{static_cast<std::uint16_t *>(cells), order});
+    default:
+        return visitor(MutableCayleyCells<std::uint32_t>{static_cast<std::uint32_t *>(cells), order});
+    }
+}
+
+// Невладеющее представление таблицы Кэли только для чтения: порядок, ширина ячейки и указатель на ячейки.
+// Дешево копируется и неявно получается из CayleyTable, поэтому функции, которым таблица нужна только для
+// чтения, принимают его вместо const CayleyTable &. Таблица должна жить дольше представления.
+class CayleyTableView
+{
+    int order = 0;
+    int cellWidth = 1;
+    const void *cells = nullptr;
+
+public:
+    CayleyTableView() = default;
+    CayleyTableView(const CayleyTable &table)
+        : order(table.getOrder()), cellWidth(table.getCellWidth()), cells(table.data()) {}
+
+    int getOrder() const { return order; }
+    int getCellWidth() const { return cellWidth; }
+    std::size_t getByteSize() const { return static_cast<std::size_t>(order) * order * cellWidth; }
+    const void *data() const { return cells; }
+
+    // Возвращает значение ячейки (row, column) без проверки границ.
+    int operator()(int row, int column) const
+    {
+        std::size_t index = static_cast<std::size_t>(row) * order + column;
+        switch (cellWidth)
+        {
+        case 1:
+            return static_cast<const std::uint8_t *>(cells)[index];
+        case 2:
+            return static_cast<const std::uint16_t *>(cells)[index];
+        default:
+            return static_cast<int>(static_cast<const std::uint32_t *>(cells)[index]);
+        }
+    }
+
+    // Как CayleyTable::visitCells.
+    template <class Visitor>
+    decltype(auto) visitCells(Visitor &&visitor) const
+    {
+        switch (cellWidth)
+        {
+        case 1:
+            return visitor(CayleyCells<std::uint8_t>{static_cast<const std::uint8_t *>(cells), order});
+        case 2:
+            return visitor(CayleyCells<std::uint16_t>{static_cast<const std::uint16_t *>(cells), order});
+        default:
+            return visitor(CayleyCells<std::uint32_t>{static_cast<const std::uint32_t *>(cells), order});
+        }
+    }
+};
+
+template <class Visitor>
+decltype(auto) CayleyTable::visitCells(Visitor &&visitor) const
+{
+    return CayleyTableView(*this).visitCells(std::forward<Visitor>(visitor));
+}
+
+CayleyTable CayleyTable::borrow(const CayleyTableView &view)
+{
+    return adoptStorage(view.getOrder(), nullptr, const_cast<void *>(view.data()));
+}
+
+// Движок замыкания подмножества под операцией квазигруппы.
+// Принадлежность хранится в плотном битовом множестве, элементы — в рабочем списке в порядке добавления.
+// Каждый новый элемент перемножается только с уже присутствующими (инкрементальное замыкание),
+// поэтому замыкание множества размера k выполняет ровно k^2 обращений к таблице за один проход.
+// Один экземпляр переиспользуется для всех начальных множеств: reset() очищает только установленные биты.
+// Для больших порядков есть closeTiled — тот же результат с обходом таблицы по строкам.
+class SubquasigroupClosureEngine
+{
+    ScratchVector<std::uint64_t> membership; // Битовое множество элементов замыкания.
+    ScratchVector<int> elements;             // Элементы замыкания в порядке добавления (рабочий список).
+    std::size_t processedCount = 0;          // Число элементов, произведения которых со всеми предыдущими уже вычислены.
+    ScratchVector<int> sortedRows;           // closeTiled: обработанные элементы по возрастанию.
+    ScratchVector<int> tileElements;         // closeTiled: элементы текущей плитки по возрастанию.
+    ScratchVector<int> mergedRows;           // closeTiled: sortedRows вместе с плиткой.
+
+public:
+    // Порядок, начиная с которого closeTiled быстрее close: таблица из 2-байтовых ячеек больше 2 МиБ
+    // и не помещается в L2.
+    static constexpr int tiledClosureMinimumOrder = 1024;
+    // Элементов в плитке closeTiled: столбцы плитки в одной строке — не больше 64 строк кэша.
+    static constexpr std::size_t closureTileSize = 64;
+    // На сколько строк вперед closeTiled подгружает ячейки.
+    static constexpr std::size_t closurePrefetchDistance = 4;
+
+    // Память движка берется из арены (по умолчанию — текущего потока), поэтому он создается внутри
+    // ScratchArena::Scope. Арена не потокобезопасна: движок, который работает в другом потоке, продолжает
+    // выделять память из нее, поэтому потокам пула нужны свои арены (см. WorkerClosureEngines).
+    // Параметры:
+    //   order: Порядок квазигруппы, задающий размер битового множества.
+    //   arena: Арена для памяти движка.
+    explicit SubquasigroupClosureEngine(int order, ScratchArena &arena = getThreadScratchArena())
+        : membership((static_cast<std::size_t>(order) + 63) / 64, 0, arena), elements(arena), sortedRows(arena),
+          tileElements(arena), mergedRows(arena)
+    {
+        elements.reserve(order);
+    }
+
+    // Очищает замыкание за O(k), где k — текущий размер.
+    void reset()
+    {
+        for (int element : elements)
+        {
+            membership[element >> 6] = 0;
+        }
+        elements.clear();
+        processedCount = 0;
+    }
+
+    bool contains(int element) const
+    {
+        return (membership[element >> 6] >> (element & 63)) & 1U;
+    }
+
+    // Добавляет элемент в рабочий список.
+    // Возвращает: true, если элемента еще не было в замыкании.
+    bool insert(int element)
+    {
+        std::uint64_t &word = membership[element >> 6];
+        std::uint64_t bit = std::uint64_t{1} << (element & 63);
+        if (word & bit)
+        {
+            return false;
+        }
+        word |= bit;
+        elements.push_back(element);
+        return true;
+    }
+
+    int size() const { return static_cast<int>(elements.size()); }
+    // Возвращает: Число элементов, уже перемноженных со всеми предыдущими; после прерванного close следующий
+    // за ними элемент перемножен лишь частично.
+    std::size_t getProcessedCount() const { return processedCount; }
+    const ScratchVector<int> &getElements() const { return elements; }
+    const ScratchVector<std::uint64_t> &getMembership() const { return membership; }
+
+    // Начинает замыкание с уже замкнутого множества: его попарные произведения не пересчитываются.
+    // Параметр closedElements: Элементы множества, замкнутого под операцией.
+    void assignClosed(const std::vector<int> &closedElements)
+    {
+        reset();
+        for (int element : closedElements)
+        {
+            insert(element);
+        }
+        processedCount = elements.size();
+    }
+
+    // Замыкает текущее множество под операцией.
+    // Параметры:
+    //   cells: Типизированное представление таблицы Кэли.
+    //   sizeLimit: Предельный размер; при его превышении после добавления элемента замыкание прерывается.
+    // Возвращает: true, если множество замкнуто, false — если размер превысил sizeLimit.
+    // Прерванное замыкание можно продолжить повторным вызовом с большим пределом.
+    template <class Cells>
+    bool close(const Cells &cells, int sizeLimit)
+    {
+        return close(cells, sizeLimit, [](int) { return true; });
+    }
+
+    // Вариант close с наблюдателем: onInsert(element) вызывается для каждого нового элемента
+    // и может прервать замыкание, вернув false.
+    template <class Cells, class InsertVisitor>
+    bool close(const Cells &cells, int sizeLimit, InsertVisitor &&onInsert)
+    {
+        QUASIGROUP_COUNT(closureCalls, 1);
+        while (processedCount < elements.size())
+        {
+            QUASIGROUP_COUNT(closurePasses, 1);
+            int newElement = elements[processedCount];
+            for (std::size_t index = 0; index <= processedCount; ++index)
+            {
+                int presentElement = elements[index];
+                int product = cells(newElement, presentElement);
+                if (insert(product) && (size() > sizeLimit || !onInsert(product)))
+                {
+                    QUASIGROUP_COUNT(productsEvaluated, 2 * index + 1);
+                    QUASIGROUP_COUNT(sizeLimitExits, size() > sizeLimit);
+                    return false;
+                }
+                product = cells(presentElement, newElement);
+                if (insert(product) && (size() > sizeLimit || !onInsert(product)))
+                {
+                    QUASIGROUP_COUNT(productsEvaluated, 2 * index + 2);
+                    QUASIGROUP_COUNT(sizeLimitExits, size() > sizeLimit);
+                    return false;
+                }
+            }
+            QUASIGROUP_COUNT(productsEvaluated, 2 * (processedCount + 1));
+            ++processedCount;
+        }
+        return true;
+    }
+
+    // Вариант close для порядков от tiledClosureMinimumOrder. В close произведения present * new читают столбец
+    // new, то есть по ячейке из каждой строки в порядке добавления, и почти каждое чтение — промах кэша и TLB.
+    // Здесь ожидающие элементы обрабатываются плитками до closureTileSize элементов X, отсортированных
+    // по возрастанию: сначала x * p для x из X и всех p — обработанных и из X — вдоль строк x, затем
+    // p * x для обработанных p, по возрастанию p: ячейки плитки в строке p читаются по возрастанию столбцов
+    // в пределах одной страницы, а строки на closurePrefetchDistance вперед подгружаются заранее. Предел
+    // размера проверяется при каждой вставке внутри плитки.
+    // Замыкание и вердикт — те же, что у close; меняется только порядок добавления элементов. После прерывания
+    // getProcessedCount указывает на начало незавершенной плитки, и следующий close пересчитает ее.
+    // Параметры и возвращаемое значение: Как у close с наблюдателем.
+    template <class Cells, class InsertVisitor>
+    bool closeTiled(const Cells &cells, int sizeLimit, InsertVisitor &&onInsert)
+    {
+        QUASIGROUP_COUNT(closureCalls, 1);
+        std::size_t order = static_cast<std::size_t>(cells.order);
+        sortedRows.assign(elements.begin(), elements.begin() + processedCount);
+        std::sort(sortedRows.begin(), sortedRows.end());
+        long long productCount = 0;
+        auto acceptProduct = [&](int product)
+        {
+            ++productCount;
+            return !insert(product) || (size() <= sizeLimit && onInsert(product));
+        };
+        auto stop = [&]
+        {
+            QUASIGROUP_COUNT(productsEvaluated, productCount);
+            QUASIGROUP_COUNT(sizeLimitExits, size() > sizeLimit);
+            return false;
+        };
+        while (processedCount < elements.size())
+        {
+            QUASIGROUP_COUNT(closurePasses, 1);
+            std::size_t tileEnd = std::min(elements.size(), processedCount + closureTileSize);
+            tileElements.assign(elements.begin() + processedCount, elements.begin() + tileEnd);
+            std::sort(tileElements.begin(), tileElements.end());
+            mergedRows.resize(sortedRows.size() + tileElements.size());
+            std::merge(sortedRows.begin(), sortedRows.end(), tileElements.begin(), tileElements.end(), mergedRows.begin());
+            for (std::size_t index = 0; index < tileElements.size(); ++index)
+            {
+                const auto *rowCells = cells.cells + static_cast<std::size_t>(tileElements[index]) * order;
+                const auto *nextCells =
+                    cells.cells + static_cast<std::size_t>(tileElements[std::min(index + 1, tileElements.size() - 1)]) * order;
+                for (int column : mergedRows)
+                {
+                    QUASIGROUP_PREFETCH(nextCells + column);
+                    if (!acceptProduct(rowCells[column]))
+                    {
+                        return stop();
+                    }
+                }
+            }
+            for (std::size_t index = 0; index < sortedRows.size(); ++index)
+            {
+                const auto *rowCells = cells.cells + static_cast<std::size_t>(sortedRows[index]) * order;
+                const auto *aheadCells =
+                    cells.cells +
+                    static_cast<std::size_t>(sortedRows[std::min(index + closurePrefetchDistance, sortedRows.size() - 1)]) * order;
+                for (int column : tileElements)
+                {
+                    QUASIGROUP_PREFETCH(aheadCells + column);
+                    if (!acceptProduct(rowCells[column]))
+                    {
+                        return stop();
+                    }
+                }
+            }
+            processedCount = tileEnd;
+            sortedRows.swap(mergedRows);
+        }
+        QUASIGROUP_COUNT(productsEvaluated, productCount);
+        return true;
+    }
+
+    // Замыкает текущее множество, выбирая close или closeTiled по порядку таблицы.
+    // Параметры и возвращаемое значение: Как у close с наблюдателем.
+    template <class Cells, class InsertVisitor>
+    bool closeForOrder(const Cells &cells, int sizeLimit, InsertVisitor &&onInsert)
+    {
+        return cells.order >= tiledClosureMinimumOrder ? closeTiled(cells, sizeLimit, onInsert)
+                                                       : close(cells, sizeLimit, onInsert);
+    }
+};
+
+// Движки замыкания для всех потоков пула на время одного запуска. Движок потока 0 (вызывающего) берет память
+// из арены этого потока, движки фоновых потоков — из собственных арен: иначе они выделяли бы память из
+// thread_local арены вызывающего потока одновременно с ним и друг с другом.
+class WorkerClosureEngines
+{
+    std::vector<ScratchArena> arenas;                // Арены потоков 1..workerCount-1; живут дольше движков.
+    std::vector<SubquasigroupClosureEngine> engines; // Движок каждого потока.
+
+public:
+    // Параметры:
+    //   order: Порядок квазигруппы.
+    //   workerCount: Число потоков пула.
+    WorkerClosureEngines(int order, unsigned workerCount) : arenas(workerCount - 1)
+    {
+        engines.reserve(workerCount);
+        engines.emplace_back(order);
+        for (ScratchArena &arena : arenas)
+        {
+            engines.emplace_back(order, arena);
+        }
+    }
+
+    SubquasigroupClosureEngine &operator[](unsigned worker) { return engines[worker]; }
+};
+
+// Хеш канонического битового множества элементов подквазигруппы.
+struct MembershipHash
+{
+    std::size_t operator()(const std::vector<std::uint64_t> &membership) const
+    {
+        std::uint64_t hash = 0xcbf29ce484222325ULL;
+        for (std::uint64_t word : membership)
+        {
+            hash = (hash ^ word) * 0x100000001b3ULL;
+            hash ^= hash >> 29;
+        }
+        return static_cast<std::size_t>(hash);
+    }
+};
+
+// Узел решётки подквазигрупп.
+struct SubquasigroupLatticeNode
+{
+    std::vector<std::uint64_t> membership; // Каноническое битовое множество элементов.
+    std::vector<int> elements;             // Элементы в порядке возрастания.
+    std::vector<int> generators;           // Порождающее множество (один или два элемента; пусто, если не найдено).
+    std::vector<int> maximalSubnodes;      // Индексы непосредственно вложенных узлов (покрытия в диаграмме Хассе).
+};
+
+// Решётка подквазигрупп, порожденных одним элементом или парой элементов, вместе с самой квазигруппой.
+// Узлы упорядочены по возрастанию размера; последний узел — вся квазигруппа.
+struct SubquasigroupLattice
+{
+    std::vector<SubquasigroupLatticeNode> nodes;
+};
+
+// Строит решётку подквазигрупп <x> и <x, y> с мемоизацией замыканий.
+// <x> собирается из уже известного <x*x>, <x, y> — из большего из <x> и <y>.
+// Замыкание пары прерывается, как только в нем оказывается элемент z, для которого <z>, <x, z> или <y, z>
+// уже известны как вся квазигруппа, либо размер превышает order/2 (собственная подквазигруппа не больше половины).
+// Шаблонный параметр Cells: Типизированное представление таблицы Кэли.
+template <class Cells>
+class SubquasigroupLatticeBuilder
+{
+    const Cells &cells;
+    int order;
+    SubquasigroupClosureEngine closure;
+    std::vector<SubquasigroupLatticeNode> nodes;
+    std::unordered_map<std::vector<std::uint64_t>, int, MembershipHash> nodeByMembership;
+    std::vector<std::uint64_t> membershipKey; // Копия битового множества движка для поиска в nodeByMembership.
+    std::vector<int> singleNodes; // Узел <x> для каждого x, -1 пока не вычислен.
+    std::vector<int> pairNodes;   // Узел <x, y> (x < y) в построчной матрице, -1 пока не вычислен.
+    int wholeNode = -1;           // Узел всей квазигруппы.
+
+public:
+    SubquasigroupLatticeBuilder(const Cells &cells, int order)
+        : cells(cells), order(order), closure(order), singleNodes(order, -1),
+          pairNodes(static_cast<std::size_t>(order) * order, -1) {}
+
+    SubquasigroupLattice build()
+    {
+        std::vector<int> wholeElements(order);
+        std::iota(wholeElements.begin(), wholeElements.end(), 0);
+        closure.assignClosed(wholeElements);
+        wholeNode = registerClosure({});
+        for (int element = 0; element < order; ++element)
+        {
+            computeSingleClosure(element);
+        }
+        for (int firstElement = 0; firstElement < order; ++firstElement)
+        {
+            for (int secondElement = firstElement + 1; secondElement < order; ++secondElement)
+            {
+                computePairClosure(firstElement, secondElement);
+            }
+        }
+        return finish();
+    }
+
+private:
+    // Регистрирует текущее содержимое движка как узел, объединяя одинаковые множества.
+    // Параметр generators: Порождающее множество, запоминаемое для нового узла.
+    // Возвращает: Индекс узла.
+    int registerClosure(const std::vector<int> &generators)
+    {
+        membershipKey.assign(closure.getMembership().begin(), closure.getMembership().end());
+        auto found = nodeByMembership.find(membershipKey);
+        if (found != nodeByMembership.end())
+        {
+            auto &node = nodes[found->second];
+            if (node.generators.empty())
+            {
+                node.generators = generators;
+            }
+            return found->second;
+        }
+        SubquasigroupLatticeNode node;
+        node.membership = membershipKey;
+        node.elements.assign(closure.getElements().begin(), closure.getElements().end());
+        std::sort(node.elements.begin(), node.elements.end());
+        node.generators = generators;
+        nodes.push_back(std::move(node));
+        nodeByMembership.emplace(nodes.back().membership, static_cast<int>(nodes.size()) - 1);
+        return static_cast<int>(nodes.size()) - 1;
+    }
+
+    // Вычисляет <element>: идет по цепочке возведения в квадрат до известного замыкания или до цикла,
+    // затем разворачивает цепочку, достраивая каждое <t> из уже известного <t*t>.
+    void computeSingleClosure(int element)
+    {
+        std::vector<int> chain;
+        int current = element;
+        while (singleNodes[current] < 0 && std::find(chain.begin(), chain.end(), current) == chain.end())
+        {
+            chain.push_back(current);
+            current = cells(current, current);
+        }
+        std::size_t tailLength = chain.size();
+        if (singleNodes[current] < 0)
+        {
+            // Все элементы цикла возведения в квадрат порождают одну и ту же подквазигруппу.
+            tailLength = std::find(chain.begin(), chain.end(), current) - chain.begin();
+            closure.reset();
+            closure.insert(current);
+            bool isProper = closure.close(cells, order / 2);
+            int node = isProper ? registerClosure({current}) : markWhole({current});
+            for (std::size_t index = tailLength; index < chain.size(); ++index)
+            {
+                singleNodes[chain[index]] = node;
+            }
+        }
+        for (std::size_t index = tailLength; index-- > 0;)
+        {
+            int tailElement = chain[index];
+            int squareNode = singleNodes[cells(tailElement, tailElement)];
+            if (squareNode == wholeNode)
+            {
+                singleNodes[tailElement] = wholeNode;
+                continue;
+            }
+            closure.assignClosed(nodes[squareNode].elements);
+            closure.insert(tailElement);
+            bool isProper = closure.close(cells, order / 2);
+            singleNodes[tailElement] = isProper ? registerClosure({tailElement}) : markWhole({tailElement});
+        }
+    }
+
+    // Вычисляет <firstElement, secondElement> для firstElement < secondElement.
+    void computePairClosure(int firstElement, int secondElement)
+    {
+        int firstNode = singleNodes[firstElement], secondNode = singleNodes[secondElement];
+        int &pairNode = pairNodes[static_cast<std::size_t>(firstElement) * order + secondElement];
+        if (firstNode == wholeNode || secondNode == wholeNode)
+        {
+            pairNode = wholeNode;
+            return;
+        }
+        const auto &firstClosure = nodes[firstNode], &secondClosure = nodes[secondNode];
+        if (containsElement(firstClosure, secondElement) || containsElement(secondClosure, firstElement))
+        {
+            pairNode = containsElement(firstClosure, secondElement) ? firstNode : secondNode;
+            return;
+        }
+        bool firstIsLarger = firstClosure.elements.size() >= secondClosure.elements.size();
+        closure.assignClosed(firstIsLarger ? firstClosure.elements : secondClosure.elements);
+        for (int element : firstIsLarger ? secondClosure.elements : firstClosure.elements)
+        {
+            closure.insert(element);
+        }
+        if (closure.size() > order / 2)
+        {
+            QUASIGROUP_COUNT(sizeLimitExits, 1);
+            pairNode = markWhole({firstElement, secondElement});
+            return;
+        }
+        bool isProper = closure.close(cells, order / 2, [&](int element)
+                                      { return !generatesWhole(firstElement, element) &&
+                                               !generatesWhole(secondElement, element); });
+        pairNode = isProper ? registerClosure({firstElement, secondElement}) : markWhole({firstElement, secondElement});
+    }
+
+    // Проверяет, известно ли уже, что <element> или <knownElement, element> — вся квазигруппа.
+    bool generatesWhole(int knownElement, int element) const
+    {
+        if (singleNodes[element] == wholeNode)
+        {
+            return true;
+        }
+        if (knownElement == element)
+        {
+            return false;
+        }
+        int lower = std::min(knownElement, element), upper = std::max(knownElement, element);
+        return pairNodes[static_cast<std::size_t>(lower) * order + upper] == wholeNode;
+    }
+
+    // Запоминает порождающее множество всей квазигруппы, если оно еще не известно.
+    // Возвращает: Индекс узла всей квазигруппы.
+    int markWhole(const std::vector<int> &generators)
+    {
+        if (nodes[wholeNode].generators.empty())
+        {
+            nodes[wholeNode].generators = generators;
+        }
+        return wholeNode;
+    }
+
+    static bool containsElement(const SubquasigroupLatticeNode &node, int element)
+    {
+        return (node.membership[element >> 6] >> (element & 63)) & 1U;
+    }
+
+    static bool isSubset(const SubquasigroupLatticeNode &subset, const SubquasigroupLatticeNode &superset)
+    {
+        for (std::size_t word = 0; word < subset.membership.size(); ++word)
+        {
+            if (subset.membership[word] & ~superset.membership[word])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Упорядочивает узлы по размеру и строит отношение покрытия (диаграмму Хассе).
+    SubquasigroupLattice finish()
+    {
+        std::sort(nodes.begin(), nodes.end(), [](const SubquasigroupLatticeNode &left, const SubquasigroupLatticeNode &right)
+                  { return left.elements.size() != right.elements.size() ? left.elements.size() < right.elements.size()
+                                                                         : left.elements < right.elements; });
+        for (std::size_t upper = 0; upper < nodes.size(); ++upper)
+        {
+            for (std::size_t lower = upper; lower-- > 0;)
+            {
+                if (nodes[lower].elements.size() == nodes[upper].elements.size() || !isSubset(nodes[lower], nodes[upper]))
+                {
+                    continue;
+                }
+                bool isCovered = std::none_of(nodes[upper].maximalSubnodes.begin(), nodes[upper].maximalSubnodes.end(),
+                                              [&](int middle) { return isSubset(nodes[lower], nodes[middle]); });
+                if (isCovered)
+                {
+                    nodes[upper].maximalSubnodes.push_back(static_cast<int>(lower));
+                }
+            }
+            std::sort(nodes[upper].maximalSubnodes.begin(), nodes[upper].maximalSubnodes.end());
+        }
+        SubquasigroupLattice lattice;
+        lattice.nodes = std::move(nodes);
+        return lattice;
+    }
+};
+
+// Начальные множества поиска подквазигрупп: циклы возведения в квадрат x, x*x, ... в порядке обхода.
+// Элементы всех множеств хранятся подряд; множество seed занимает [offsets[seed], offsets[seed + 1]).
+struct SquaringCycleSeeds
+{
+    ScratchVector<int> elements;
+    ScratchVector<int> offsets;
+
+    // Параметр order: Порядок квазигруппы; под элементы сразу резервируется order мест.
+    explicit SquaringCycleSeeds(int order) : elements(getThreadScratchArena()), offsets(1, 0, getThreadScratchArena())
+    {
+        elements.reserve(order);
+        offsets.reserve(static_cast<std::size_t>(order) + 1);
+    }
+
+    std::size_t count() const { return offsets.size() - 1; }
+
+    // Загружает множество seed в движок замыкания.
+    void load(std::size_t seed, SubquasigroupClosureEngine &closure) const
+    {
+        closure.reset();
+        for (int index = offsets[seed]; index < offsets[seed + 1]; ++index)
+        {
+            closure.insert(elements[index]);
+        }
+    }
+};
+
+// Строит начальные множества: для каждого еще не посещенного элемента — его путь возведения в квадрат
+// (хвост и цикл).
+// Параметр cells: Типизированное представление таблицы Кэли.
+template <class Cells>
+SquaringCycleSeeds collectSquaringCycleSeeds(const Cells &cells)
+{
+    int order = cells.order;
+    SquaringCycleSeeds seeds(order);
+    ScratchVector<bool> visitedElements(order, false, getThreadScratchArena());
+    ScratchVector<int> cycleOfElement(order, -1, getThreadScratchArena());
+    for (int startElement = 0; startElement < order; ++startElement)
+    {
+        if (!visitedElements[startElement])
+        {
+            int seed = static_cast<int>(seeds.count());
+            int currentElement = startElement;
+            while (cycleOfElement[currentElement] != seed)
+            {
+                QUASIGROUP_COUNT(squaringWalkSteps, 1);
+                cycleOfElement[currentElement] = seed;
+                visitedElements[currentElement] = true;
+                seeds.elements.push_back(currentElement);
+                currentElement = cells(currentElement, currentElement);
+            }
+            seeds.offsets.push_back(static_cast<int>(seeds.elements.size()));
+        }
+    }
+    return seeds;
+}
+
+// Проверяет, есть ли элемент x с x * x != x. Путь возведения в квадрат такого элемента содержит не меньше двух
+// элементов, а путь идемпотента — только его самого, поэтому нетривиальная подквазигруппа, порожденная
+// начальным множеством, находится тогда и только тогда, когда есть неидемпотентный элемент. Время O(n).
+// Параметр cells: Типизированное представление таблицы Кэли.
+template <class Cells>
+bool hasNonIdempotentElement(const Cells &cells)
+{
+    for (int element = 0; element < cells.order; ++element)
+    {
+        if (static_cast<int>(cells(element, element)) != element)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Результат совместной проверки собственных и нетривиальных подквазигрупп.
+// Свидетели — замыкания первых (в порядке обхода) начальных множеств, давших каждый из вердиктов.
+struct SubquasigroupAnalysis
+{
+    bool hasProperSubquasigroups = false;     // Найдена собственная подквазигруппа (размер < порядок).
+    bool hasNonTrivialSubquasigroups = false; // Найдена нетривиальная подквазигруппа (размер > 1).
+    std::vector<int> properWitness;           // Элементы собственной подквазигруппы по возрастанию.
+    std::vector<int> nonTrivialWitness;       // Элементы нетривиальной подквазигруппы по возрастанию.
+};
+
+// Представляет конечную квазигруппу — алгебраическую структуру с бинарной операцией, образующей латинский квадрат.
+// Хранит таблицу Кэли и предоставляет методы для проверки собственных и нетривиальных подквазигрупп.
+class Quasigroup
+{
+    CayleyTable cayleyTable;                                 // Таблица Кэли, хранящая операцию квазигруппы.
+    int order;                                               // Порядок (размер) квазигруппы.
+    mutable std::optional<SubquasigroupAnalysis> cachedAnalysis; // Результат analyzeSubquasigroups после первого вызова.
+    mutable std::optional<CayleyTable> leftDivisionTable;        // Ячейка (a, b) = a \ b; строится при первом обращении.
+    mutable std::optional<CayleyTable> rightDivisionTable;       // Ячейка (b, a) = b / a; строится при первом обращении.
+
+public:
+    // Конструирует квазигруппу поверх чужой таблицы Кэли без копирования (CayleyTable::borrow).
+    // Параметр view: Таблица, задающая операцию; должна жить дольше квазигруппы и не меняться.
+    explicit Quasigroup(CayleyTableView view)
+        : cayleyTable(CayleyTable::borrow(view)), order(view.getOrder()) {}
+
+    // Конструирует квазигруппу, забирая буфер таблицы без копирования (в том числе отображенный в память файл).
+    // Параметр cayleyTable: Таблица Кэли; после вызова пуста.
+    explicit Quasigroup(CayleyTable &&cayleyTable)
+        : cayleyTable(std::move(cayleyTable)), order(this->cayleyTable.getOrder()) {}
+
+    int getOrder() const { return order; }
+    const CayleyTable &getCayleyTable() const { return cayleyTable; }
+
+    // Отдает таблицу Кэли без копирования, например чтобы переиспользовать буфер для следующей таблицы.
+    // Возвращает: Таблицу Кэли; квазигруппа после вызова пуста.
+    CayleyTable releaseCayleyTable()
+    {
+        cachedAnalysis.reset();
+        leftDivisionTable.reset();
+        rightDivisionTable.reset();
+        order = 0;
+        return std::move(cayleyTable);
+    }
+
+    // Вычисляет результат операции квазигруппы для двух элементов.
+    // Параметры:
+    //   firstElement, secondElement: Индексы элементов (от 0 до order-1).
+    // Возвращает: Результат операции (firstElement * secondElement) из таблицы Кэли.
+    // Выбрасывает: std::out_of_range при некорректных индексах.
+    int applyOperation(int firstElement, int secondElement) const
+    {
+        checkElements(firstElement, secondElement);
+        return cayleyTable(firstElement, secondElement);
+    }
+
+    // Быстрый вариант applyOperation без проверки границ для горячих циклов.
+    int operator()(int firstElement, int secondElement) const
+    {
+        return cayleyTable(firstElement, secondElement);
+    }
+
+    // Левое деление: решает a * x = b за O(1) по таблице левого деления.
+    // Параметры:
+    //   leftFactor: Элемент a.
+    //   product: Элемент b.
+    // Возвращает: Единственный x = a \ b.
+    // Выбрасывает: std::out_of_range при некорректных индексах.
+    int leftDivide(int leftFactor, int product) const
+    {
+        checkElements(leftFactor, product);
+        return getLeftDivisionTable()(leftFactor, product);
+    }
+
+    // Правое деление: решает x * a = b за O(1) по таблице правого деления.
+    // Параметры:
+    //   product: Элемент b.
+    //   rightFactor: Элемент a.
+    // Возвращает: Единственный x = b / a.
+    // Выбрасывает: std::out_of_range при некорректных индексах.
+    int rightDivide(int product, int rightFactor) const
+    {
+        checkElements(product, rightFactor);
+        return getRightDivisionTable()(product, rightFactor);
+    }
+
+    // Таблица левого деления (парастроф): ячейка (a, b) содержит a \ b. Строится при первом вызове одним проходом
+    // по строкам таблицы Кэли, в той же плоской раскладке и с той же шириной ячейки; при n <= 256 три таблицы
+    // вместе занимают не больше 192 КиБ. Таблица Кэли должна быть латинским квадратом.
+    // Кэш не синхронизирован, как и analyzeSubquasigroups.
+    const CayleyTable &getLeftDivisionTable() const
+    {
+        if (!leftDivisionTable)
+        {
+            CayleyTable division(order);
+            cayleyTable.visitCells([&](const auto &cells)
+                                   {
+                                       division.visitMutableCells([&](auto target)
+                                                                  {
+                                                                      for (int row = 0; row < order; ++row)
+                                                                      {
+                                                                          for (int column = 0; column < order; ++column)
+                                                                          {
+                                                                              target.set(row, cells(row, column), column);
+                                                                          }
+                                                                      } }); });
+            leftDivisionTable = std::move(division);
+        }
+        return *leftDivisionTable;
+    }
+
+    // Таблица правого деления: ячейка (b, a) содержит b / a. Строится при первом вызове; условия как у
+    // getLeftDivisionTable.
+    const CayleyTable &getRightDivisionTable() const
+    {
+        if (!rightDivisionTable)
+        {
+            CayleyTable division(order);
+            cayleyTable.visitCells([&](const auto &cells)
+                                   {
+                                       division.visitMutableCells([&](auto target)
+                                                                  {
+                                                                      for (int row = 0; row < order; ++row)
+                                                                      {
+                                                                          for (int column = 0; column < order; ++column)
+                                                                          {
+                                                                              target.set(cells(row, column), column, row);
+                                                                          }
+                                                                      } }); });
+            rightDivisionTable = std::move(division);
+        }
+        return *rightDivisionTable;
+    }
+
+    // Проверяет наличие подквазигрупп (собственных или нетривиальных).
+    // Параметр checkForProperSubquasigroups:
+    //   - true: Проверяет собственные подквазигруппы (размер < порядок).
+    //   - false: Проверяет нетривиальные подквазигруппы (размер > 1).
+    // Возвращает: true, если подквазигруппа указанного типа существует, false — иначе.
+    // Собственные ищутся замыканием путей возведения в квадрат, нетривиальные — проходом по диагонали
+    // (hasNonIdempotentElement).
+    bool hasSubquasigroups(bool checkForProperSubquasigroups) const
+    {
+        if (cachedAnalysis)
+        {
+            return checkForProperSubquasigroups ? cachedAnalysis->hasProperSubquasigroups
+                                                : cachedAnalysis->hasNonTrivialSubquasigroups;
+        }
+        if (!checkForProperSubquasigroups)
+        {
+            return cayleyTable.visitCells([](const auto &cells) { return hasNonIdempotentElement(cells); });
+        }
+        return cayleyTable.visitCells([&](const auto &cells) { return hasProperSubquasigroupsIn(cells); });
+    }
+
+    // Параллельный вариант hasSubquasigroups: замыкания начальных множеств распределяются по потокам пула.
+    // Первый поток, нашедший подквазигруппу, поднимает флаг отмены, и остальные прекращают работу,
+    // в том числе посреди замыкания. Начальные множества те же, что и в последовательном варианте.
+    // Параметр pool: Пул потоков; при одном потоке выполняется последовательный вариант.
+    bool hasSubquasigroups(bool checkForProperSubquasigroups, WorkStealingThreadPool &pool) const
+    {
+        if (pool.getWorkerCount() == 1 || cachedAnalysis || !checkForProperSubquasigroups)
+        {
+            return hasSubquasigroups(checkForProperSubquasigroups);
+        }
+        return cayleyTable.visitCells([&](const auto &cells) { return hasProperSubquasigroupsInParallel(cells, pool); });
+    }
+
+    // Выполняет обе проверки за один проход: замыкание каждого начального множества строится один раз
+    // и дает оба вердикта; после отсечения по order/2 замыкание при необходимости продолжается до конца.
+    // Возвращает: Результат, сохраняемый в экземпляре; повторные вызовы ничего не пересчитывают.
+    // Кэш не синхронизирован: один экземпляр не следует анализировать из нескольких потоков одновременно.
+    const SubquasigroupAnalysis &analyzeSubquasigroups() const
+    {
+        if (!cachedAnalysis)
+        {
+            cachedAnalysis = cayleyTable.visitCells([&](const auto &cells) { return analyzeSubquasigroupsIn(cells); });
+        }
+        return *cachedAnalysis;
+    }
+
+    // Параллельный вариант analyzeSubquasigroups с тем же результатом, включая свидетелей.
+    // Параметр pool: Пул потоков; при одном потоке выполняется последовательный вариант.
+    const SubquasigroupAnalysis &analyzeSubquasigroups(WorkStealingThreadPool &pool) const
+    {
+        if (!cachedAnalysis && pool.getWorkerCount() > 1)
+        {
+            cachedAnalysis = cayleyTable.visitCells([&](const auto &cells)
+                                                    { return analyzeSubquasigroupsInParallel(cells, pool); });
+        }
+        return analyzeSubquasigroups();
+    }
+
+    // Перечисляет все подквазигруппы, порожденные одним элементом или парой элементов.
+    // Возвращает: Решётку с размерами, порождающими множествами и отношением вложения узлов.
+    SubquasigroupLattice enumerateSubquasigroupLattice() const
+    {
+        return cayleyTable.visitCells([&](const auto &cells)
+                                      {
+                                          ScratchArena::Scope scratchScope(getThreadScratchArena());
+                                          return SubquasigroupLatticeBuilder<std::decay_t<decltype(cells)>>(cells, order).build();
+                                      });
+    }
+
+private:
+    // Выбрасывает std::out_of_range, если какой-либо из двух индексов вне 0..order-1.
+    void checkElements(int firstElement, int secondElement) const
+    {
+        if (firstElement < 0 || firstElement >= order || secondElement < 0 || secondElement >= order)
+        {
+            throw std::out_of_range("Индекс вне диапазона таблицы Кэли");
+        }
+    }
+
+    // Реализация hasSubquasigroups(true) для конкретной ширины ячейки.
+    // Параметр cells: Типизированное представление таблицы Кэли.
+    template <class Cells>
+    bool hasProperSubquasigroupsIn(const Cells &cells) const
+    {
+        ScratchArena::Scope scratchScope(getThreadScratchArena());
+        SquaringCycleSeeds seeds = collectSquaringCycleSeeds(cells);
+        SubquasigroupClosureEngine closure(order);
+        for (std::size_t seed = 0; seed < seeds.count(); ++seed)
+        {
+            seeds.load(seed, closure);
+            if (verifyProperSubquasigroup(cells, closure))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Реализация параллельного hasSubquasigroups(true): у каждого потока свой движок замыкания.
+    template <class Cells>
+    bool hasProperSubquasigroupsInParallel(const Cells &cells, WorkStealingThreadPool &pool) const
+    {
+        ScratchArena::Scope scratchScope(getThreadScratchArena());
+        SquaringCycleSeeds seeds = collectSquaringCycleSeeds(cells);
+        WorkerClosureEngines closures(order, pool.getWorkerCount());
+        std::atomic<bool> witnessFound{false};
+        pool.run(seeds.count(), [&](std::size_t seed, unsigned worker)
+                 {
+                     auto &closure = closures[worker];
+                     seeds.load(seed, closure);
+                     bool isWitness = verifyProperSubquasigroup(cells, closure, [&] { return !pool.isCancelled(); });
+                     if (isWitness)
+                     {
+                         witnessFound.store(true, std::memory_order_relaxed);
+                     }
+                     return !isWitness; });
+        return witnessFound.load(std::memory_order_relaxed);
+    }
+
+    // Реализация analyzeSubquasigroups для конкретной ширины ячейки.
+    template <class Cells>
+    SubquasigroupAnalysis analyzeSubquasigroupsIn(const Cells &cells) const
+    {
+        ScratchArena::Scope scratchScope(getThreadScratchArena());
+        SquaringCycleSeeds seeds = collectSquaringCycleSeeds(cells);
+        SubquasigroupClosureEngine closure(order);
+        SubquasigroupAnalysis analysis;
+        for (std::size_t seed = 0; seed < seeds.count(); ++seed)
+        {
+            if (analysis.hasProperSubquasigroups && analysis.hasNonTrivialSubquasigroups)
+            {
+                break;
+            }
+            seeds.load(seed, closure);
+            analyzeSeed(cells, closure, !analysis.hasProperSubquasigroups, !analysis.hasNonTrivialSubquasigroups,
+                        analysis, [] { return true; });
+        }
+        return analysis;
+    }
+
+    // Реализация параллельного analyzeSubquasigroups. Чтобы свидетели совпадали с последовательным вариантом,
+    // потоки запоминают наименьший номер начального множества для каждого вердикта и пропускают
+    // работу для множеств с большими номерами.
+    template <class Cells>
+    SubquasigroupAnalysis analyzeSubquasigroupsInParallel(const Cells &cells, WorkStealingThreadPool &pool) const
+    {
+        ScratchArena::Scope scratchScope(getThreadScratchArena());
+        SquaringCycleSeeds seeds = collectSquaringCycleSeeds(cells);
+        WorkerClosureEngines closures(order, pool.getWorkerCount());
+        std::atomic<std::size_t> properSeed{seeds.count()}, nonTrivialSeed{seeds.count()};
+        std::mutex resultMutex;
+        SubquasigroupAnalysis analysis;
+        pool.run(seeds.count(), [&](std::size_t seed, unsigned worker)
+                 {
+                     bool needProper = seed < properSeed.load(std::memory_order_relaxed);
+                     bool needNonTrivial = seed < nonTrivialSeed.load(std::memory_order_relaxed);
+                     if (!needProper && !needNonTrivial)
+                     {
+                         return true;
+                     }
+                     auto &closure = closures[worker];
+                     seeds.load(seed, closure);
+                     SubquasigroupAnalysis seedAnalysis;
+                     analyzeSeed(cells, closure, needProper, needNonTrivial, seedAnalysis,
+                                 [&] { return seed < properSeed.load(std::memory_order_relaxed); });
+                     std::lock_guard<std::mutex> lock(resultMutex);
+                     if (seedAnalysis.hasProperSubquasigroups && seed < properSeed.load(std::memory_order_relaxed))
+                     {
+                         properSeed.store(seed, std::memory_order_relaxed);
+                         analysis.hasProperSubquasigroups = true;
+                         analysis.properWitness = std::move(seedAnalysis.properWitness);
+                     }
+                     if (seedAnalysis.hasNonTrivialSubquasigroups && seed < nonTrivialSeed.load(std::memory_order_relaxed))
+                     {
+                         nonTrivialSeed.store(seed, std::memory_order_relaxed);
+                         analysis.hasNonTrivialSubquasigroups = true;
+                         analysis.nonTrivialWitness = std::move(seedAnalysis.nonTrivialWitness);
+                     }
+                     return true; });
+        return analysis;
+    }
+
+    // Замыкает одно начальное множество и записывает в analysis недостающие вердикты со свидетелями.
+    // Параметры:
+    //   closure: Движок, содержащий начальное множество.
+    //   needProper, needNonTrivial: Какие вердикты еще требуются.
+    //   shouldContinueProper: Позволяет прервать поиск собственной подквазигруппы извне.
+    template <class Cells, class ContinuePredicate>
+    void analyzeSeed(const Cells &cells, SubquasigroupClosureEngine &closure, bool needProper, bool needNonTrivial,
+                     SubquasigroupAnalysis &analysis, ContinuePredicate &&shouldContinueProper) const
+    {
+        needNonTrivial = needNonTrivial && closure.size() > 1;
+        bool isClosed = false;
+        if (needProper)
+        {
+            isClosed = closure.closeForOrder(cells, order / 2, [&](int) { return shouldContinueProper(); });
+            if (isClosed && closure.size() < order)
+            {
+                analysis.hasProperSubquasigroups = true;
+                analysis.properWitness = sortedElements(closure);
+            }
+        }
+        if (needNonTrivial)
+        {
+            if (!isClosed)
+            {
+                closure.close(cells, order);
+            }
+            analysis.hasNonTrivialSubquasigroups = true;
+            analysis.nonTrivialWitness = sortedElements(closure);
+        }
+    }
+
+    static std::vector<int> sortedElements(const SubquasigroupClosureEngine &closure)
+    {
+        std::vector<int> elements(closure.getElements().begin(), closure.getElements().end());
+        std::sort(elements.begin(), elements.end());
+        return elements;
+    }
+
+    // Проверяет, порождает ли начальное множество собственную подквазигруппу (размер < порядок).
+    // Параметр closure: Движок, содержащий начальное множество; после вызова содержит (частичное) замыкание.
+    // Возвращает: true, если порожденное множество — собственная подквазигруппа, false — иначе.
+    // Замыкает множество под операцией, останавливаясь при размере > порядок/2.
+    template <class Cells>
+    bool verifyProperSubquasigroup(const Cells &cells, SubquasigroupClosureEngine &closure) const
+    {
+        return verifyProperSubquasigroup(cells, closure, [] { return true; });
+    }
+
+    // Вариант verifyProperSubquasigroup, прерываемый извне: shouldContinue() опрашивается
+    // при каждом новом элементе, и возврат false означает отказ от этого начального множества.
+    template <class Cells, class ContinuePredicate>
+    bool verifyProperSubquasigroup(const Cells &cells, SubquasigroupClosureEngine &closure,
+                                   ContinuePredicate &&shouldContinue) const
+    {
+        if (!closure.closeForOrder(cells, order / 2, [&](int) { return shouldContinue(); }))
+        {
+            return false;
+        }
+        return closure.size() < order;
+    }
+};
+
+// Инкрементальная проверка подквазигрупп изменяемой таблицы: после правки ячеек или строк пересчитываются
+// только замыкания, прочитавшие измененные ячейки.
+// Вердикты совпадают с Quasigroup::hasSubquasigroups для текущей таблицы. Для каждого начального множества
+// (пути возведения в квадрат) запоминаются результат и множество зависимостей P — элементы, произведения которых
+// замыкание уже перемножило попарно (для замкнутых — все элементы замыкания, для прерванных на order / 2 —
+// обычно около sqrt(order / 2) первых элементов). Замыкание читает только ячейки P x P, поэтому правка ячейки
+// (r, c) делает результат недействительным, лишь если r и c оба лежат в P.
+// Результат зависит только от множества, а не от порядка загрузки, поэтому результаты находятся по битовому
+// множеству начального множества и переживают смену диагонали, если само множество не изменилось.
+// Правки копятся и применяются при следующем запросе вердикта. Проверять, что таблица осталась латинским
+// квадратом, — дело вызывающего кода.
+class IncrementalSubquasigroupAnalyzer
+{
+    struct SeedResult
+    {
+        std::vector<std::uint64_t> dependencies; // Битовое множество P.
+        bool isProper = false;                   // Начальное множество порождает собственную подквазигруппу.
+    };
+
+    CayleyTable cayleyTable;
+    int order;
+    int wordCount;
+    std::unordered_map<std::vector<std::uint64_t>, SeedResult, MembershipHash> results; // По множеству начального элемента.
+    std::vector<std::pair<int, int>> editedCells; // Измененные ячейки с последнего обновления.
+    std::vector<int> editedRows;                  // Строки, замененные целиком.
+    std::vector<std::uint64_t> seedKey;           // Битовое множество начального множества для поиска в results.
+    bool isUpToDate = false;
+    bool hasProper = false, hasNonTrivial = false;
+    long long recomputedCount = 0; // Замыкания, пересчитанные при последнем обновлении.
+
+public:
+    // Параметр cayleyTable: Таблица Кэли; анализатор владеет ею и меняет ее на месте.
+    explicit IncrementalSubquasigroupAnalyzer(CayleyTable cayleyTable)
+        : cayleyTable(std::move(cayleyTable)), order(this->cayleyTable.getOrder()), wordCount((order + 63) / 64) {}
+
+    const CayleyTable &getCayleyTable() const { return cayleyTable; }
+    int getOrder() const { return order; }
+
+    // Записывает value в ячейку (row, column).
+    // Выбрасывает: std::out_of_range при индексах или значении вне 0..order-1.
+    void setCell(int row, int column, int value)
+    {
+        checkElement(row);
+        checkElement(column);
+        checkElement(value);
+        if (cayleyTable(row, column) != value)
+        {
+            cayleyTable.set(row, column, value);
+            editedCells.emplace_back(row, column);
+            isUpToDate = false;
+        }
+    }
+
+    // Заменяет строку row значениями values (например, строкой, заново построенной генератором).
+    // Выбрасывает: std::invalid_argument при длине values, не равной порядку; std::out_of_range при значениях вне таблицы.
+    void assignRow(int row, const std::vector<int> &values)
+    {
+        checkElement(row);
+        if (static_cast<int>(values.size()) != order)
+        {
+            throw std::invalid_argument("Длина строки не совпадает с порядком таблицы");
+        }
+        for (int value : values)
+        {
+            checkElement(value);
+        }
+        for (int column = 0; column < order; ++column)
+        {
+            cayleyTable.set(row, column, values[column]);
+        }
+        editedRows.push_back(row);
+        isUpToDate = false;
+    }
+
+    // Меняет местами строки firstRow и secondRow.
+    void swapRows(int firstRow, int secondRow)
+    {
+        checkElement(firstRow);
+        checkElement(secondRow);
+        if (firstRow == secondRow)
+        {
+            return;
+        }
+        for (int column = 0; column < order; ++column)
+        {
+            int value = cayleyTable(firstRow, column);
+            cayleyTable.set(firstRow, column, cayleyTable(secondRow, column));
+            cayleyTable.set(secondRow, column, value);
+        }
+        editedRows.push_back(firstRow);
+        editedRows.push_back(secondRow);
+        isUpToDate = false;
+    }
+
+    // Возвращает: Вердикт hasSubquasigroups(true) для текущей таблицы.
+    bool hasProperSubquasigroups()
+    {
+        refresh();
+        return hasProper;
+    }
+
+    // Возвращает: Вердикт hasSubquasigroups(false): есть начальное множество из двух и более элементов.
+    bool hasNonTrivialSubquasigroups()
+    {
+        refresh();
+        return hasNonTrivial;
+    }
+
+    // Возвращает: Число замыканий, пересчитанных при последнем обновлении (остальные взяты из запомненных).
+    long long getRecomputedClosureCount() const { return recomputedCount; }
+
+private:
+    void checkElement(int element) const
+    {
+        if (element < 0 || element >= order)
+        {
+            throw std::out_of_range("Индекс вне диапазона таблицы Кэли");
+        }
+    }
+
+    static bool testBit(const std::vector<std::uint64_t> &words, int element)
+    {
+        return (words[element >> 6] >> (element & 63)) & 1U;
+    }
+
+    // Удаляет результаты, зависящие от измененных ячеек и строк.
+    void invalidateEditedResults()
+    {
+        // При правках порядка размера таблицы дешевле пересчитать все.
+        if (editedCells.size() + editedRows.size() * order > static_cast<std::size_t>(order) * order / 4)
+        {
+            results.clear();
+        }
+        for (auto result = results.begin(); result != results.end() && (!editedCells.empty() || !editedRows.empty());)
+        {
+            const std::vector<std::uint64_t> &dependencies = result->second.dependencies;
+            bool isAffected = std::any_of(editedRows.begin(), editedRows.end(),
+                                          [&](int row) { return testBit(dependencies, row); }) ||
+                              std::any_of(editedCells.begin(), editedCells.end(), [&](const std::pair<int, int> &cell)
+                                          { return testBit(dependencies, cell.first) && testBit(dependencies, cell.second); });
+            result = isAffected ? results.erase(result) : std::next(result);
+        }
+        editedCells.clear();
+        editedRows.clear();
+    }
+
+    void refresh()
+    {
+        if (isUpToDate)
+        {
+            return;
+        }
+        invalidateEditedResults();
+        cayleyTable.visitCells([&](const auto &cells) { refreshIn(cells); });
+        isUpToDate = true;
+    }
+
+    // Обновляет вердикты по текущим начальным множествам. Как и hasSubquasigroups, останавливается на первой
+    // собственной подквазигруппе: сначала просматриваются запомненные результаты, и только если среди них нет
+    // собственной, по очереди замыкаются множества без результата. Результаты исчезнувших множеств
+    // отбрасываются, когда их становится больше, чем текущих.
+    template <class Cells>
+    void refreshIn(const Cells &cells)
+    {
+        ScratchArena::Scope scratchScope(getThreadScratchArena());
+        SquaringCycleSeeds seeds = collectSquaringCycleSeeds(cells);
+        SubquasigroupClosureEngine closure(order);
+        ScratchVector<int> missingSeeds(getThreadScratchArena());
+        hasProper = hasNonTrivial = false;
+        recomputedCount = 0;
+        for (std::size_t seed = 0; seed < seeds.count(); ++seed)
+        {
+            seeds.load(seed, closure);
+            hasNonTrivial = hasNonTrivial || closure.size() > 1;
+            seedKey.assign(closure.getMembership().begin(), closure.getMembership().end());
+            auto known = results.find(seedKey);
+            if (known == results.end())
+            {
+                missingSeeds.push_back(static_cast<int>(seed));
+            }
+            else
+            {
+                hasProper = hasProper || known->second.isProper;
+            }
+        }
+        for (std::size_t index = 0; index < missingSeeds.size() && !hasProper; ++index)
+        {
+            seeds.load(missingSeeds[index], closure);
+            seedKey.assign(closure.getMembership().begin(), closure.getMembership().end());
+            if (results.count(seedKey))
+            {
+                continue; // Два начальных элемента дали одно и то же множество.
+            }
+            ++recomputedCount;
+            SeedResult result;
+            result.isProper = closure.close(cells, order / 2) && closure.size() < order;
+            result.dependencies.assign(wordCount, 0);
+            const ScratchVector<int> &elements = closure.getElements();
+            std::size_t readCount = std::min(elements.size(), closure.getProcessedCount() + 1);
+            for (std::size_t element = 0; element < readCount; ++element)
+            {
+                result.dependencies[elements[element] >> 6] |= std::uint64_t{1} << (elements[element] & 63);
+            }
+            hasProper = result.isProper;
+            results.emplace(seedKey, std::move(result));
+        }
+        if (results.size() > 2 * seeds.count())
+        {
+            pruneResults(seeds);
+        }
+    }
+
+    // Оставляет только результаты текущих начальных множеств.
+    void pruneResults(const SquaringCycleSeeds &seeds)
+    {
+        std::unordered_map<std::vector<std::uint64_t>, SeedResult, MembershipHash> currentResults;
+        SubquasigroupClosureEngine closure(order);
+        for (std::size_t seed = 0; seed < seeds.count(); ++seed)
+        {
+            seeds.load(seed, closure);
+            seedKey.assign(closure.getMembership().begin(), closure.getMembership().end());
+            auto known = results.find(seedKey);
+            if (known != results.end())
+            {
+                currentResults.emplace(seedKey, std::move(known->second));
+                results.erase(known);
+            }
+        }
+        results = std::move(currentResults);
+    }
+};
+
+// Наибольший порядок FixedOrderQuasigroup: множество элементов помещается в 16-битную маску.
+constexpr int maximumFixedQuasigroupOrder = 16;
+
+// Квазигруппа порядка N <= 16, известного при компиляции, для массовой проверки малых таблиц.
+// Таблица хранится в std::array по байту на ячейку (256 байт при N = 16), множества элементов — в 16-битной
+// маске, рабочий список замыкания — в массиве на стеке: ни выделений памяти, ни проверок границ, ни ветвления
+// по ширине ячейки, а умножение на N компилятор заменяет сдвигом.
+// Вердикты и свидетели совпадают с Quasigroup::analyzeSubquasigroups для той же таблицы: начальные множества —
+// те же пути возведения в квадрат, собственная подквазигруппа ищется с отсечением по N / 2.
+// Таблицы циклической группы и аффинных квазигрупп строятся constexpr-функциями, как и проверка подквазигрупп,
+// поэтому вердикт для фиксированной таблицы можно получить и при компиляции.
+template <int N>
+class FixedOrderQuasigroup
+{
+    static_assert(N >= 1 && N <= maximumFixedQuasigroupOrder, "Порядок FixedOrderQuasigroup должен быть от 1 до 16");
+
+public:
+    using Mask = std::uint16_t;                     // Множество элементов: бит x — элемент x.
+    using Table = std::array<std::uint8_t, N * N>; // Ячейка (x, y) хранится в table[x * N + y].
+
+private:
+    Table table{}; // Таблица Кэли по строкам.
+
+public:
+    // Параметр table: Ячейки таблицы Кэли; что это латинский квадрат, не проверяется.
+    constexpr explicit FixedOrderQuasigroup(const Table &table) : table(table) {}
+
+    // Копирует таблицу Кэли порядка N.
+    // Параметр view: Таблица; обычно уже проверена validateLatinSquare.
+    // Выбрасывает: std::invalid_argument, если порядок таблицы не равен N.
+    static FixedOrderQuasigroup fromCayleyTable(CayleyTableView view)
+    {
+        if (view.getOrder() != N)
+        {
+            throw std::invalid_argument("Порядок таблицы не совпадает с порядком FixedOrderQuasigroup");
+        }
+        Table table{};
+        view.visitCells([&](const auto &cells)
+                        {
+                            for (int row = 0; row < N; ++row)
+                            {
+                                for (int column = 0; column < N; ++column)
+                                {
+                                    table[row * N + column] = static_cast<std::uint8_t>(cells(row, column));
+                                }
+                            } });
+        return FixedOrderQuasigroup(table);
+    }
+
+    // Возвращает: Циклическую группу Z_N (x * y = (x + y) mod N), как generateCyclicGroupCayleyTable.
+    static constexpr FixedOrderQuasigroup cyclicGroup() { return affine(1, 1, 0); }
+
+    // Строит аффинную квазигруппу x * y = (alpha * x + beta * y + c) mod N с тождественной f.
+    // Параметры и исключения: См. вариант с перестановкой.
+    static constexpr FixedOrderQuasigroup affine(int coefficientAlpha, int coefficientBeta, int constantC)
+    {
+        std::array<std::uint8_t, N> identityFunction{};
+        for (int element = 0; element < N; ++element)
+        {
+            identityFunction[element] = static_cast<std::uint8_t>(element);
+        }
+        return affine(coefficientAlpha, coefficientBeta, constantC, identityFunction);
+    }
+
+    // Строит аффинную квазигруппу x * y = (alpha * x + beta * f(y) + c) mod N,
+    // как generateAffineQuasigroupCayleyTable.
+    // Параметры: См. validateAffineQuasigroupParameters; permutationFunction — перестановка f чисел 0..N-1.
+    // Выбрасывает: std::invalid_argument при некорректных параметрах; при вычислении во время компиляции
+    // некорректные параметры дают ошибку компиляции.
+    static constexpr FixedOrderQuasigroup affine(int coefficientAlpha, int coefficientBeta, int constantC,
+                                                 const std::array<std::uint8_t, N> &permutationFunction)
+    {
+        if (std::gcd(coefficientAlpha, N) != 1 || std::gcd(coefficientBeta, N) != 1)
+        {
+            throw std::invalid_argument("alpha и beta должны быть взаимно простыми с порядком");
+        }
+        if (constantC < 0 || constantC >= N)
+        {
+            throw std::invalid_argument("c должно быть в диапазоне [0, n-1]");
+        }
+        unsigned seenValues = 0;
+        for (std::uint8_t value : permutationFunction)
+        {
+            if (value >= N || (seenValues >> value & 1U))
+            {
+                throw std::invalid_argument("f должна быть перестановкой чисел 0..n-1");
+            }
+            seenValues |= 1U << value;
+        }
+        int reducedAlpha = (coefficientAlpha % N + N) % N, reducedBeta = (coefficientBeta % N + N) % N;
+        Table table{};
+        for (int row = 0; row < N; ++row)
+        {
+            for (int column = 0; column < N; ++column)
+            {
+                table[row * N + column] =
+                    static_cast<std::uint8_t>((reducedAlpha * row + reducedBeta * permutationFunction[column] + constantC) % N);
+            }
+        }
+        return FixedOrderQuasigroup(table);
+    }
+
+    static constexpr int getOrder() { return N; }
+    constexpr const Table &getTable() const { return table; }
+
+    // Вычисляет результат операции без проверки границ.
+    constexpr int operator()(int firstElement, int secondElement) const { return table[firstElement * N + secondElement]; }
+
+    // Вычисляет результат операции квазигруппы для двух элементов.
+    // Параметры:
+    //   firstElement, secondElement: Индексы элементов (от 0 до N-1).
+    // Возвращает: Результат операции из таблицы.
+    // Выбрасывает: std::out_of_range при некорректных индексах.
+    int applyOperation(int firstElement, int secondElement) const
+    {
+        if (firstElement < 0 || firstElement >= N || secondElement < 0 || secondElement >= N)
+        {
+            throw std::out_of_range("Индекс вне диапазона таблицы Кэли");
+        }
+        return (*this)(firstElement, secondElement);
+    }
+
+    // Строит плотную таблицу Кэли той же квазигруппы.
+    CayleyTable materialize() const
+    {
+        CayleyTable cayleyTable(N);
+        for (int row = 0; row < N; ++row)
+        {
+            for (int column = 0; column < N; ++column)
+            {
+                cayleyTable.set(row, column, (*this)(row, column));
+            }
+        }
+        return cayleyTable;
+    }
+
+    // Проверяет наличие подквазигрупп, как Quasigroup::hasSubquasigroups.
+    // Параметр checkForProperSubquasigroups: true — собственные (размер < N), false — нетривиальные (размер > 1).
+    // Возвращает: true, если подквазигруппа указанного типа существует.
+    constexpr bool hasSubquasigroups(bool checkForProperSubquasigroups) const
+    {
+        if (!checkForProperSubquasigroups)
+        {
+            // Как hasNonIdempotentElement: нетривиальная подквазигруппа есть, если x * x != x для некоторого x.
+            for (int element = 0; element < N; ++element)
+            {
+                if ((*this)(element, element) != element)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+        Mask visitedElements = 0, largeGenerators = 0;
+        for (int startElement = 0; startElement < N; ++startElement)
+        {
+            if (visitedElements >> startElement & 1U)
+            {
+                continue;
+            }
+            Mask seed = collectSquaringPath(startElement);
+            visitedElements |= seed;
+            if (isProperClosure(close(seed, N / 2, largeGenerators)))
+            {
+                return true;
+            }
+            largeGenerators |= static_cast<Mask>(1U << startElement);
+        }
+        return false;
+    }
+
+    // Выполняет обе проверки за один проход, как Quasigroup::analyzeSubquasigroups.
+    // Возвращает: Результат анализа со свидетелями; память выделяется только под свидетелей.
+    SubquasigroupAnalysis analyzeSubquasigroups() const
+    {
+        SubquasigroupAnalysis analysis;
+        Mask visitedElements = 0, largeGenerators = 0;
+        for (int startElement = 0; startElement < N; ++startElement)
+        {
+            if (analysis.hasProperSubquasigroups && analysis.hasNonTrivialSubquasigroups)
+            {
+                break;
+            }
+            if (visitedElements >> startElement & 1U)
+            {
+                continue;
+            }
+            Mask seed = collectSquaringPath(startElement);
+            visitedElements |= seed;
+            if (!analysis.hasProperSubquasigroups)
+            {
+                Mask closure = close(seed, N / 2, largeGenerators);
+                if (isProperClosure(closure))
+                {
+                    analysis.hasProperSubquasigroups = true;
+                    analysis.properWitness = elementsOf(closure);
+                }
+                largeGenerators |= static_cast<Mask>(1U << startElement);
+            }
+            if (!analysis.hasNonTrivialSubquasigroups && hasSeveralElements(seed))
+            {
+                analysis.hasNonTrivialSubquasigroups = true;
+                analysis.nonTrivialWitness = elementsOf(close(seed, N));
+            }
+        }
+        return analysis;
+    }
+
+private:
+    static constexpr bool hasSeveralElements(Mask elements) { return (elements & (elements - 1)) != 0; }
+    static constexpr bool isProperClosure(Mask closure) { return closure != 0 && __builtin_popcount(closure) < N; }
+
+    // Возвращает: Путь возведения в квадрат от startElement (хвост и цикл), как collectSquaringCycleSeeds.
+    constexpr Mask collectSquaringPath(int startElement) const
+    {
+        Mask path = 0;
+        for (int element = startElement; !(path >> element & 1U); element = (*this)(element, element))
+        {
+            path |= static_cast<Mask>(1U << element);
+        }
+        return path;
+    }
+
+    // Замыкает множество под операцией тем же инкрементальным обходом, что SubquasigroupClosureEngine.
+    // Параметры:
+    //   members: Начальное множество.
+    //   sizeLimit: Предельный размер.
+    //   largeGenerators: Элементы, порождающие подквазигруппу размера больше sizeLimit. Путь возведения
+    //                    в квадрат лежит в подквазигруппе, порожденной его началом, поэтому замыкание
+    //                    начального множества — это подквазигруппа, порожденная началом, и начала отвергнутых
+    //                    множеств сюда подходят: встретив такой элемент, замыкание прерывается сразу.
+    // Возвращает: Замыкание или 0, если его размер превысил sizeLimit.
+    constexpr Mask close(Mask members, int sizeLimit, Mask largeGenerators = 0) const
+    {
+        std::array<std::uint8_t, N + 1> elements{}; // Лишнее место — для записи вставки при полном множестве.
+        int size = 0;
+        for (unsigned rest = members; rest != 0; rest &= rest - 1)
+        {
+            elements[size++] = static_cast<std::uint8_t>(__builtin_ctz(rest));
+        }
+        // Вставка без ветвления: новизна произведения почти случайна и плохо предсказывается, поэтому элемент
+        // пишется в конец списка всегда, а размер растет на 0 или 1.
+        auto insert = [&](int product)
+        {
+            Mask bit = static_cast<Mask>(1U << product);
+            elements[size] = static_cast<std::uint8_t>(product);
+            size += (members & bit) == 0;
+            members |= bit;
+        };
+        for (int processedCount = 0; processedCount < size; ++processedCount)
+        {
+            int newElement = elements[processedCount];
+            for (int index = 0; index <= processedCount; ++index)
+            {
+                int presentElement = elements[index];
+                insert((*this)(newElement, presentElement));
+                insert((*this)(presentElement, newElement));
+                // Предел проверяется после пары произведений: замыкание не меняется, а превышение
+                // обнаруживается не позже чем на одно произведение.
+                if (size > sizeLimit || (members & largeGenerators) != 0)
+                {
+                    return 0;
+                }
+            }
+        }
+        return members;
+    }
+
+    static std::vector<int> elementsOf(Mask members)
+    {
+        std::vector<int> elements;
+        for (int element = 0; element < N; ++element)
+        {
+            if (members >> element & 1U)
+            {
+                elements.push_back(element);
+            }
+        }
+        return elements;
+    }
+};
+
+// Выбирает FixedOrderQuasigroup по порядку, известному только во время выполнения:
+// вызывает visitor(std::integral_constant<int, N>()) для N = order.
+// Параметры:
+//   order: Порядок от 1 до maximumFixedQuasigroupOrder.
+//   visitor: Обобщенная лямбда; ее результат возвращается.
+template <int N = 1, class Visitor>
+auto visitFixedOrder(int order, Visitor &&visitor)
+{
+    if constexpr (N < maximumFixedQuasigroupOrder)
+    {
+        if (order != N)
+        {
+            return visitFixedOrder<N + 1>(order, std::forward<Visitor>(visitor));
+        }
+    }
+    return visitor(std::integral_constant<int, N>());
+}
+
+// Наибольший порядок полного перебора. Порядок 7 занимает около 11 процессорных часов; латинских квадратов
+// порядка 8 примерно в 1.8 * 10^6 раз больше, и этот перебор их не закончит.
+constexpr int maximumEnumerationOrder = 7;
+
+// Счетчик полного перебора. Латинских квадратов порядка 7 около 6 * 10^13, это помещается в 64 бита, но
+// счетчик не зависит от maximumEnumerationOrder и не переполнится и при порядках 8 и 9 (около 10^20 и 10^27).
+// 128-битное число из двух 64-битных половин: unsigned __int128 есть не у всех компиляторов (MSVC).
+struct EnumerationCount
+{
+    std::uint64_t low = 0;  // Младшие 64 бита.
+    std::uint64_t high = 0; // Старшие 64 бита.
+
+    // Прибавляет произведение first * second (по модулю 2^128).
+    void addProduct(std::uint64_t first, std::uint64_t second)
+    {
+        constexpr std::uint64_t lowMask = 0xffffffffULL;
+        std::uint64_t lowLow = (first & lowMask) * (second & lowMask), lowHigh = (first & lowMask) * (second >> 32),
+                      highLow = (first >> 32) * (second & lowMask), highHigh = (first >> 32) * (second >> 32);
+        std::uint64_t middle = (lowLow >> 32) + (lowHigh & lowMask) + (highLow & lowMask);
+        std::uint64_t productLow = (middle << 32) | (lowLow & lowMask);
+        std::uint64_t productHigh = highHigh + (lowHigh >> 32) + (highLow >> 32) + (middle >> 32);
+        low += productLow;
+        high += productHigh + (low < productLow);
+    }
+
+    // Делит счетчик на divisor > 0 столбиком по 32-битным цифрам.
+    // Возвращает: Остаток.
+    std::uint32_t divide(std::uint32_t divisor)
+    {
+        std::uint64_t limbs[4] = {high >> 32, high & 0xffffffffULL, low >> 32, low & 0xffffffffULL};
+        std::uint64_t remainder = 0;
+        for (std::uint64_t &limb : limbs)
+        {
+            std::uint64_t current = remainder << 32 | limb;
+            limb = current / divisor;
+            remainder = current % divisor;
+        }
+        high = limbs[0] << 32 | limbs[1];
+        low = limbs[2] << 32 | limbs[3];
+        return static_cast<std::uint32_t>(remainder);
+    }
+};
+
+// Возвращает: Десятичную запись счетчика перебора.
+std::string formatEnumerationCount(EnumerationCount value)
+{
+    std::string digits;
+    do
+    {
+        digits.push_back(static_cast<char>('0' + value.divide(10)));
+    } while (value.low != 0 || value.high != 0);
+    return std::string(digits.rbegin(), digits.rend());
+}
+
+// Класс первых строк при переобозначениях sigma с sigma(0) = 0: такое переобозначение оставляет первую строку
+// первой, а строку-перестановку r переводит в sigma r sigma^-1.
+struct FirstRowClass
+{
+    std::vector<int> row;        // Представитель: цикл 0 -> 1 -> ... -> l-1 -> 0, затем остальные циклы подряд.
+    unsigned long long size = 0; // Число первых строк в классе.
+};
+
+// Перечисляет классы первых строк порядка order. Класс задается длиной l цикла перестановки, содержащего 0,
+// и длинами остальных циклов; в нем (n-1)! / prod(i^m_i * m_i!) перестановок, где m_i — число остальных
+// циклов длины i.
+// Параметр order: Порядок от 1 до maximumEnumerationOrder.
+// Возвращает: Классы в порядке возрастания l.
+std::vector<FirstRowClass> enumerateFirstRowClasses(int order)
+{
+    unsigned long long permutationsFixingZero = 1;
+    for (int factor = 2; factor < order; ++factor)
+    {
+        permutationsFixingZero *= static_cast<unsigned long long>(factor);
+    }
+    std::vector<FirstRowClass> classes;
+    std::vector<int> cycleLengths;
+    // Перебирает разбиения остатка на невозрастающие длины циклов, не больше largestLength.
+    std::function<void(int, int)> appendPartitions = [&](int remainder, int largestLength)
+    {
+        if (remainder == 0)
+        {
+            FirstRowClass firstRowClass;
+            firstRowClass.row.resize(order);
+            unsigned long long centralizerSize = 1;
+            int start = 0, repeatCount = 0;
+            for (std::size_t index = 0; index < cycleLengths.size(); ++index)
+            {
+                int length = cycleLengths[index];
+                for (int offset = 0; offset < length; ++offset)
+                {
+                    firstRowClass.row[start + offset] = start + (offset + 1) % length;
+                }
+                start += length;
+                if (index > 0)
+                {
+                    repeatCount = cycleLengths[index - 1] == length && index > 1 ? repeatCount + 1 : 1;
+                    centralizerSize *= static_cast<unsigned long long>(length) * repeatCount;
+                }
+            }
+            firstRowClass.size = permutationsFixingZero / centralizerSize;
+            classes.push_back(std::move(firstRowClass));
+            return;
+        }
+        for (int length = std::min(remainder, largestLength); length >= 1; --length)
+        {
+            cycleLengths.push_back(length);
+            appendPartitions(remainder - length, length);
+            cycleLengths.pop_back();
+        }
+    };
+    for (int zeroCycleLength = 1; zeroCycleLength <= order; ++zeroCycleLength)
+    {
+        cycleLengths.assign(1, zeroCycleLength);
+        appendPartitions(order - zeroCycleLength, order - zeroCycleLength);
+    }
+    return classes;
+}
+
+// Полный перебор латинских квадратов порядка N с возвратом, по ячейкам построчно.
+// Состояние — битовые маски символов, уже занятых в каждой строке и каждом столбце: допустимые символы ячейки
+// получаются одним OR и NOT, а перебираются по младшему биту.
+// В режиме подсчета квадратов без собственных подквазигрупп подквазигруппа понимается точно: это <x> != Q
+// хотя бы для одного x, где <x> — подквазигруппа, порожденная x. Такое свойство не зависит от обозначений,
+// поэтому перебор можно вести по классам первых строк. Quasigroup::hasSubquasigroups смотрит только на начала
+// путей возведения в квадрат, и для отобранных здесь квадратов его ответ тоже false.
+// Отсечения:
+//   - идемпотент x * x = x — уже подквазигруппа {x}, поэтому символ x исключается из ячейки (x, x);
+//   - после каждой заполненной строки k замыкаются <x> для x <= k, пока они не выходят за строки 0..k,
+//     таблица которых известна. Замкнувшееся так <x> — собственная подквазигруппа, и ветвь отсекается.
+//     Элементы, чье <x> превысило N / 2, порождают всю квазигруппу при любом продолжении и больше
+//     не проверяются.
+template <int N>
+class LatinSquareEnumerator
+{
+    using Mask = std::uint16_t;
+    static constexpr Mask allElements = static_cast<Mask>((1U << N) - 1);
+
+    std::array<std::uint8_t, N * N> table{}; // Заполненные ячейки по строкам.
+    std::array<Mask, N> rowSymbols{};        // Символы, уже стоящие в строке.
+    std::array<Mask, N> columnSymbols{};     // Символы, уже стоящие в столбце.
+    bool countsAllSquares;                   // true — считать все квадраты, false — только без подквазигрупп.
+
+public:
+    // Параметр countsAllSquares: true — без отсечений по подквазигруппам (проверка перебора по известным числам).
+    explicit LatinSquareEnumerator(bool countsAllSquares) : countsAllSquares(countsAllSquares) {}
+
+    // Добавляет в prefixes первые prefixRows строк всех допустимых продолжений первой строки firstRow,
+    // по N * prefixRows байт на префикс; каждый префикс — независимая задача перебора.
+    // Возвращает: Число добавленных префиксов.
+    std::size_t collectPrefixes(const std::vector<int> &firstRow, int prefixRows, std::vector<std::uint8_t> &prefixes)
+    {
+        Mask generators = 0;
+        if (!loadRows(firstRow.data(), 1, generators))
+        {
+            return 0;
+        }
+        std::size_t before = prefixes.size();
+        fill(N, prefixRows * N, generators, [&](Mask)
+             { prefixes.insert(prefixes.end(), table.begin(), table.begin() + prefixRows * N); });
+        return (prefixes.size() - before) / (static_cast<std::size_t>(prefixRows) * N);
+    }
+
+    // Считает квадраты, начинающиеся с заданных строк.
+    // Параметры:
+    //   prefix: prefixRows строк из collectPrefixes.
+    //   prefixRows: Число строк префикса.
+    // Возвращает: Число латинских квадратов (без собственных подквазигрупп, если не countsAllSquares).
+    unsigned long long countCompletions(const std::uint8_t *prefix, int prefixRows)
+    {
+        Mask generators = 0;
+        if (!loadRows(prefix, prefixRows, generators))
+        {
+            return 0;
+        }
+        unsigned long long count = 0;
+        fill(prefixRows * N, N * N, generators, [&](Mask) { ++count; });
+        return count;
+    }
+
+private:
+    void place(int row, int column, int value)
+    {
+        table[row * N + column] = static_cast<std::uint8_t>(value);
+        rowSymbols[row] |= static_cast<Mask>(1U << value);
+        columnSymbols[column] |= static_cast<Mask>(1U << value);
+    }
+
+    void remove(int row, int column, int value)
+    {
+        rowSymbols[row] &= static_cast<Mask>(~(1U << value));
+        columnSymbols[column] &= static_cast<Mask>(~(1U << value));
+    }
+
+    // Заполняет таблицу строками 0..rowCount-1 и применяет к ним те же отсечения, что и перебор.
+    // Возвращает: false, если строки уже дают собственную подквазигруппу.
+    template <class Value>
+    bool loadRows(const Value *rows, int rowCount, Mask &generators)
+    {
+        rowSymbols.fill(0);
+        columnSymbols.fill(0);
+        for (int row = 0; row < rowCount; ++row)
+        {
+            for (int column = 0; column < N; ++column)
+            {
+                place(row, column, static_cast<int>(rows[row * N + column]));
+            }
+            if (!countsAllSquares && hasKnownProperSubquasigroup(row, generators))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Перебирает значения ячеек cell..endCell-1 и вызывает onComplete(generators) для каждого заполнения.
+    template <class CompletionVisitor>
+    void fill(int cell, int endCell, Mask generators, CompletionVisitor &&onComplete)
+    {
+        if (cell == endCell)
+        {
+            onComplete(generators);
+            return;
+        }
+        int row = cell / N, column = cell % N;
+        if (row == N - 1 && column == 0 && endCell == N * N)
+        {
+            fillLastRow(generators, onComplete);
+            return;
+        }
+        Mask candidates = static_cast<Mask>(allElements & ~(rowSymbols[row] | columnSymbols[column]));
+        if (!countsAllSquares && row == column && N > 1)
+        {
+            candidates &= static_cast<Mask>(~(1U << row));
+        }
+        for (unsigned rest = candidates; rest != 0; rest &= rest - 1)
+        {
+            int value = __builtin_ctz(rest);
+            place(row, column, value);
+            Mask nextGenerators = generators;
+            if (countsAllSquares || column < N - 1 || !hasKnownProperSubquasigroup(row, nextGenerators))
+            {
+                fill(cell + 1, endCell, nextGenerators, onComplete);
+            }
+            remove(row, column, value);
+        }
+    }
+
+    // Последняя строка латинского прямоугольника определена однозначно: в каждом столбце недостает одного символа.
+    template <class CompletionVisitor>
+    void fillLastRow(Mask generators, CompletionVisitor &&onComplete)
+    {
+        for (int column = 0; column < N; ++column)
+        {
+            table[(N - 1) * N + column] = static_cast<std::uint8_t>(__builtin_ctz(allElements & ~columnSymbols[column]));
+        }
+        bool isPruned = !countsAllSquares && ((N > 1 && table[N * N - 1] == N - 1) ||
+                                              hasKnownProperSubquasigroup(N - 1, generators));
+        if (!isPruned)
+        {
+            onComplete(generators);
+        }
+    }
+
+    // Проверяет подквазигруппы, целиком видимые в строках 0..lastRow.
+    // Параметры:
+    //   lastRow: Последняя заполненная строка.
+    //   generators: Элементы, уже известные как порождающие всю квазигруппу; дополняется.
+    // Возвращает: true, если некоторое <x> замкнулось внутри строк 0..lastRow и меньше N.
+    bool hasKnownProperSubquasigroup(int lastRow, Mask &generators) const
+    {
+        Mask knownRows = static_cast<Mask>((1U << (lastRow + 1)) - 1);
+        for (unsigned rest = knownRows & ~generators; rest != 0; rest &= rest - 1)
+        {
+            int startElement = __builtin_ctz(rest);
+            std::array<std::uint8_t, N + 1> elements{};
+            elements[0] = static_cast<std::uint8_t>(startElement);
+            Mask members = static_cast<Mask>(1U << startElement);
+            int size = 1;
+            bool isUndetermined = false, isGenerator = false;
+            for (int processedCount = 0; processedCount < size && !isUndetermined && !isGenerator; ++processedCount)
+            {
+                int newElement = elements[processedCount];
+                for (int index = 0; index <= processedCount; ++index)
+                {
+                    int presentElement = elements[index];
+                    for (int product : {static_cast<int>(table[newElement * N + presentElement]),
+                                        static_cast<int>(table[presentElement * N + newElement])})
+                    {
+                        Mask bit = static_cast<Mask>(1U << product);
+                        elements[size] = static_cast<std::uint8_t>(product);
+                        size += (members & bit) == 0;
+                        members |= bit;
+                    }
+                    // <x> с порождающим элементом или с размером больше N / 2 — вся квазигруппа; элемент вне
+                    // строк 0..lastRow не дает досчитать замыкание.
+                    if (size > N / 2 || (members & generators) != 0)
+                    {
+                        isGenerator = true;
+                        break;
+                    }
+                    if ((members & ~knownRows) != 0)
+                    {
+                        isUndetermined = true;
+                        break;
+                    }
+                }
+            }
+            if (isGenerator)
+            {
+                generators |= static_cast<Mask>(1U << startElement);
+            }
+            else if (!isUndetermined && size < N)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+// Результат полного перебора латинских квадратов.
+struct LatinSquareEnumeration
+{
+    EnumerationCount squareCount;       // Найденные квадраты (все или без собственных подквазигрупп).
+    std::size_t firstRowClassCount = 0; // Классы первой строки (FirstRowClass).
+    std::size_t taskCount = 0;          // Префиксы из двух строк, распределенные по потокам.
+};
+
+// Считает латинские квадраты порядка order полным перебором. Первая строка перебирается по классам
+// FirstRowClass: свойство "нет собственных подквазигрупп" не меняется при переобозначении, поэтому число
+// квадратов с первой строкой из класса — размер класса, умноженный на число квадратов с ее представителем.
+// Префиксы из двух строк — независимые задачи, которые пул распределяет с перехватом работы.
+// Параметры:
+//   order: Порядок от 1 до maximumEnumerationOrder.
+//   countsAllSquares: true — все латинские квадраты, false — только без собственных подквазигрупп.
+//   pool: Пул потоков.
+// Выбрасывает: std::invalid_argument при недопустимом порядке.
+LatinSquareEnumeration enumerateLatinSquares(int order, bool countsAllSquares, WorkStealingThreadPool &pool)
+{
+    if (order < 1 || order > maximumEnumerationOrder)
+    {
+        throw std::invalid_argument("Порядок перебора должен быть от 1 до " + std::to_string(maximumEnumerationOrder));
+    }
+    return visitFixedOrder(order, [&](auto fixedOrder)
+                           {
+                               constexpr int N = decltype(fixedOrder)::value;
+                               LatinSquareEnumeration enumeration;
+                               std::vector<FirstRowClass> classes = enumerateFirstRowClasses(N);
+                               enumeration.firstRowClassCount = classes.size();
+                               int prefixRows = std::min(N, 2);
+                               std::vector<std::uint8_t> prefixes;
+                               std::vector<std::size_t> prefixClasses;
+                               LatinSquareEnumerator<N> prefixEnumerator(countsAllSquares);
+                               for (std::size_t classIndex = 0; classIndex < classes.size(); ++classIndex)
+                               {
+                                   std::size_t count = prefixEnumerator.collectPrefixes(classes[classIndex].row, prefixRows, prefixes);
+                                   prefixClasses.insert(prefixClasses.end(), count, classIndex);
+                               }
+                               enumeration.taskCount = prefixClasses.size();
+                               std::vector<unsigned long long> counts(prefixClasses.size());
+                               std::vector<LatinSquareEnumerator<N>> enumerators(pool.getWorkerCount(),
+                                                                                LatinSquareEnumerator<N>(countsAllSquares));
+                               pool.run(prefixClasses.size(), [&](std::size_t task, unsigned worker)
+                                        {
+                                            counts[task] = enumerators[worker].countCompletions(
+                                                &prefixes[task * prefixRows * N], prefixRows);
+                                            return true; });
+                               for (std::size_t task = 0; task < counts.size(); ++task)
+                               {
+                                   enumeration.squareCount.addProduct(counts[task], classes[prefixClasses[task]].size);
+                               }
+                               return enumeration; });
+}
+
+// Преобразования строк над квазигруппой порядка n <= 256 (e-преобразование Марковского и обратное к нему).
+// Для лидера l кодирование e_l переводит a_1 ... a_k в b_1 ... b_k, где b_0 = l и b_i = b_{i-1} * a_i;
+// декодирование d_l восстанавливает a_i = b_{i-1} \ b_i по таблице левого деления (b_{i-1} * a_i = b_i).
+// Несколько лидеров l_1, ..., l_r задают раунды E = e_{l_r} o ... o e_{l_1}; все раунды выполняются
+// за один проход по данным, поэтому каждый байт читается и пишется один раз.
+// Обе операции хранятся плоскими байтовыми таблицами с индексом (x << s) | y, где 2^s — наименьшая степень
+// двойки не меньше n: одно обращение на шаг без умножения. При n = 256 это таблицы 256 x 256 (вместе 128 КиБ,
+// в кэше L2), при n <= 64 обе таблицы вместе занимают не больше 8 КиБ и остаются в L1. Кодирование одного потока — цепочка зависимых обращений
+// к таблице, поэтому для пропускной способности независимые потоки обрабатываются чередованием дорожек:
+// за шаг выполняется по одному обращению в каждой дорожке, и задержки обращений перекрываются.
+// Состояние — последний выход каждого раунда — передается вызывающим, так что длинный поток можно
+// обрабатывать частями.
+class QuasigroupStringTransformer
+{
+    int order;                                // Порядок квазигруппы.
+    unsigned rowShift;                        // s: строки таблиц идут с шагом 2^s >= n.
+    std::vector<std::uint8_t> multiplication; // x * y по индексу (x << s) | y.
+    std::vector<std::uint8_t> leftDivision;   // x \ y — единственное z с x * z = y — по индексу (x << s) | y.
+
+public:
+    static constexpr int maximumOrder = 256;
+    static constexpr std::size_t laneCount = 8; // Дорожек в encodeStreams и decodeStreams за один проход.
+
+    // Переупаковывает таблицу Кэли и таблицу левого деления квазигруппы (Quasigroup::getLeftDivisionTable).
+    // Параметр quasigroup: Квазигруппа порядка от 1 до 256.
+    // Выбрасывает: std::invalid_argument при порядке больше 256.
+    explicit QuasigroupStringTransformer(const Quasigroup &quasigroup)
+        : order(quasigroup.getOrder()), rowShift(0)
+    {
+        if (order < 1 || order > maximumOrder)
+        {
+            throw std::invalid_argument("Преобразование строк требует квазигруппы порядка от 1 до 256");
+        }
+        while ((1 << rowShift) < order)
+        {
+            ++rowShift;
+        }
+        multiplication.assign(std::size_t(1) << (2 * rowShift), 0);
+        leftDivision.assign(multiplication.size(), 0);
+        const CayleyTable &division = quasigroup.getLeftDivisionTable();
+        for (int row = 0; row < order; ++row)
+        {
+            for (int column = 0; column < order; ++column)
+            {
+                multiplication[(row << rowShift) | column] = static_cast<std::uint8_t>(quasigroup(row, column));
+                leftDivision[(row << rowShift) | column] = static_cast<std::uint8_t>(division(row, column));
+            }
+        }
+    }
+
+    int getOrder() const { return order; }
+
+    // Кодирует поток: output = E(input) для раундов с текущим состоянием.
+    // Параметры:
+    //   state: Последний выход каждого раунда; перед первым вызовом — лидеры l_1, ..., l_r. Обновляется.
+    //   input, output: Буферы длины length; допускается input == output.
+    // Выбрасывает: std::invalid_argument, если байт или лидер не является элементом квазигруппы.
+    void encode(std::vector<std::uint8_t> &state, const std::uint8_t *input, std::uint8_t *output,
+                std::size_t length) const
+    {
+        transformStreams<false>(state, &input, &output, 1, length);
+    }
+
+    // Декодирует поток: output = E^{-1}(input); state имеет тот же смысл, что и в encode (лидеры при начале).
+    void decode(std::vector<std::uint8_t> &state, const std::uint8_t *input, std::uint8_t *output,
+                std::size_t length) const
+    {
+        transformStreams<true>(state, &input, &output, 1, length);
+    }
+
+    // Кодирует streamCount независимых потоков одинаковой длины, чередуя их по дорожкам.
+    // Параметры:
+    //   states: Состояния потоков подряд, по r байт на поток.
+    //   inputs, outputs: Массивы из streamCount указателей на буферы длины length.
+    void encodeStreams(std::vector<std::uint8_t> &states, const std::uint8_t *const *inputs,
+                       std::uint8_t *const *outputs, std::size_t streamCount, std::size_t length) const
+    {
+        transformStreams<false>(states, inputs, outputs, streamCount, length);
+    }
+
+    // Декодирует streamCount независимых потоков; параметры как в encodeStreams.
+    void decodeStreams(std::vector<std::uint8_t> &states, const std::uint8_t *const *inputs,
+                       std::uint8_t *const *outputs, std::size_t streamCount, std::size_t length) const
+    {
+        transformStreams<true>(states, inputs, outputs, streamCount, length);
+    }
+
+private:
+    // Проверяет, что байты — элементы квазигруппы. При n = 256 подходит любой байт; иначе максимум
+    // буфера находится одним векторизуемым проходом.
+    void validateSymbols(const std::uint8_t *bytes, std::size_t length) const
+    {
+        if (order == maximumOrder)
+        {
+            return;
+        }
+        std::uint8_t maximum = 0;
+        for (std::size_t index = 0; index < length; ++index)
+        {
+            maximum = std::max(maximum, bytes[index]);
+        }
+        if (length > 0 && maximum >= order)
+        {
+            throw std::invalid_argument("Байт " + std::to_string(maximum) +
+                                        " не является элементом квазигруппы порядка " + std::to_string(order));
+        }
+    }
+
+    // Общая реализация: состояния проверяются, затем потоки обрабатываются группами по laneCount дорожек.
+    // Раунды выполняются группами по maximumRoundsPerPass за проход; если раундов больше, следующие группы
+    // проходят по уже записанному выходу (при декодировании — в обратном порядке групп).
+    template <bool isDecoding>
+    void transformStreams(std::vector<std::uint8_t> &states, const std::uint8_t *const *inputs,
+                          std::uint8_t *const *outputs, std::size_t streamCount, std::size_t length) const
+    {
+        if (streamCount == 0 || states.empty() || states.size() % streamCount != 0)
+        {
+            throw std::invalid_argument("Нужен хотя бы один лидер на каждый поток");
+        }
+        validateSymbols(states.data(), states.size());
+        for (std::size_t stream = 0; stream < streamCount; ++stream)
+        {
+            validateSymbols(inputs[stream], length);
+        }
+        std::size_t roundCount = states.size() / streamCount;
+        std::size_t groupCount = (roundCount + maximumRoundsPerPass - 1) / maximumRoundsPerPass;
+        for (std::size_t pass = 0; pass < groupCount; ++pass)
+        {
+            std::size_t group = isDecoding ? groupCount - 1 - pass : pass;
+            std::size_t firstRound = group * maximumRoundsPerPass;
+            std::size_t groupRounds = std::min(maximumRoundsPerPass, roundCount - firstRound);
+            const std::uint8_t *const *sources = pass == 0 ? inputs : outputs;
+            std::size_t stream = 0;
+            for (; stream + laneCount <= streamCount; stream += laneCount)
+            {
+                transformLanes<isDecoding, laneCount>(states.data() + stream * roundCount + firstRound, roundCount,
+                                                      groupRounds, sources + stream, outputs + stream, length);
+            }
+            for (; stream < streamCount; ++stream)
+            {
+                transformLanes<isDecoding, 1>(states.data() + stream * roundCount + firstRound, roundCount,
+                                              groupRounds, sources + stream, outputs + stream, length);
+            }
+        }
+    }
+
+    static constexpr std::size_t maximumRoundsPerPass = 16;
+
+    // Обрабатывает Lanes потоков одновременно. Состояния и указатели на буферы копируются в локальные массивы:
+    // байтовые записи в выход не могут их изменить, и компилятор держит их в регистрах. Раунды идут внешним
+    // циклом по дорожкам, чтобы обращения разных дорожек к таблице были независимы.
+    // Параметры:
+    //   states: Состояние первого раунда группы в первом потоке; состояния потока идут с шагом stateStride.
+    //   roundCount: Раундов в группе (не больше maximumRoundsPerPass).
+    template <bool isDecoding, std::size_t Lanes>
+    void transformLanes(std::uint8_t *states, std::size_t stateStride, std::size_t roundCount,
+                        const std::uint8_t *const *inputs, std::uint8_t *const *outputs, std::size_t length) const
+    {
+        const std::uint8_t *table = isDecoding ? leftDivision.data() : multiplication.data();
+        unsigned shift = rowShift;
+        unsigned roundStates[maximumRoundsPerPass][Lanes];
+        const std::uint8_t *sources[Lanes];
+        std::uint8_t *destinations[Lanes];
+        for (std::size_t lane = 0; lane < Lanes; ++lane)
+        {
+            sources[lane] = inputs[lane];
+            destinations[lane] = outputs[lane];
+            for (std::size_t round = 0; round < roundCount; ++round)
+            {
+                roundStates[round][lane] = states[lane * stateStride + round];
+            }
+        }
+        for (std::size_t index = 0; index < length; ++index)
+        {
+            unsigned symbols[Lanes];
+            for (std::size_t lane = 0; lane < Lanes; ++lane)
+            {
+                symbols[lane] = sources[lane][index];
+            }
+            for (std::size_t step = 0; step < roundCount; ++step)
+            {
+                // Декодирование снимает раунды в обратном порядке: сначала последний.
+                unsigned *previous = roundStates[isDecoding ? roundCount - 1 - step : step];
+                for (std::size_t lane = 0; lane < Lanes; ++lane)
+                {
+                    unsigned result = table[(previous[lane] << shift) | symbols[lane]];
+                    previous[lane] = isDecoding ? symbols[lane] : result;
+                    symbols[lane] = result;
+                }
+            }
+            for (std::size_t lane = 0; lane < Lanes; ++lane)
+            {
+                destinations[lane][index] = static_cast<std::uint8_t>(symbols[lane]);
+            }
+        }
+        for (std::size_t lane = 0; lane < Lanes; ++lane)
+        {
+            for (std::size_t round = 0; round < roundCount; ++round)
+            {
+                states[lane * stateStride + round] = static_cast<std::uint8_t>(roundStates[round][lane]);
+            }
+        }
+    }
+};
+
+// Вердикты подквазигрупп одной таблицы.
+struct SubquasigroupVerdicts
+{
+    bool hasProperSubquasigroups = false;
+    bool hasNonTrivialSubquasigroups = false;
+};
+
+// Проверяет подквазигруппы одной таблицы так же, как пакетный режим: порядки до maximumFixedQuasigroupOrder —
+// ядром FixedOrderQuasigroup, остальные — Quasigroup поверх таблицы без копирования.
+// Параметры:
+//   table: Латинский квадрат.
+//   checkProper, checkNonTrivial: Нужные вердикты; ненужные остаются false.
+//   pool: Пул для проверки одной таблицы (см. Quasigroup::hasSubquasigroups с пулом).
+//   witnesses: Если не nullptr, получает полный анализ со свидетелями (для записей .qgr); свидетели
+//              непроверенных вердиктов пусты.
+// Возвращает: Вердикты таблицы.
+SubquasigroupVerdicts checkSubquasigroups(CayleyTableView table, bool checkProper, bool checkNonTrivial,
+                                             WorkStealingThreadPool &pool, SubquasigroupAnalysis *witnesses = nullptr)
+{
+    SubquasigroupVerdicts verdicts;
+    if (witnesses)
+    {
+        *witnesses = SubquasigroupAnalysis();
+    }
+    if (!checkProper && !checkNonTrivial)
+    {
+        return verdicts;
+    }
+    auto takeAnalysis = [&](const SubquasigroupAnalysis &analysis)
+    {
+        verdicts.hasProperSubquasigroups = checkProper && analysis.hasProperSubquasigroups;
+        verdicts.hasNonTrivialSubquasigroups = checkNonTrivial && analysis.hasNonTrivialSubquasigroups;
+        if (witnesses)
+        {
+            witnesses->hasProperSubquasigroups = verdicts.hasProperSubquasigroups;
+            witnesses->hasNonTrivialSubquasigroups = verdicts.hasNonTrivialSubquasigroups;
+            if (verdicts.hasProperSubquasigroups)
+            {
+                witnesses->properWitness = analysis.properWitness;
+            }
+            if (verdicts.hasNonTrivialSubquasigroups)
+            {
+                witnesses->nonTrivialWitness = analysis.nonTrivialWitness;
+            }
+        }
+        return verdicts;
+    };
+    int order = table.getOrder();
+    if (order >= 1 && order <= maximumFixedQuasigroupOrder)
+    {
+        return visitFixedOrder(order, [&](auto fixedOrder)
+                               {
+                                   auto quasigroup = FixedOrderQuasigroup<decltype(fixedOrder)::value>::fromCayleyTable(table);
+                                   if (witnesses)
+                                   {
+                                       return takeAnalysis(quasigroup.analyzeSubquasigroups());
+                                   }
+                                   verdicts.hasProperSubquasigroups = checkProper && quasigroup.hasSubquasigroups(true);
+                                   verdicts.hasNonTrivialSubquasigroups = checkNonTrivial && quasigroup.hasSubquasigroups(false);
+                                   return verdicts; });
+    }
+    Quasigroup quasigroup(table);
+    if (witnesses)
+    {
+        return takeAnalysis(quasigroup.analyzeSubquasigroups(pool));
+    }
+    // Без свидетелей проверки раздельны: analyzeSubquasigroups замыкал бы свидетеля нетривиальной
+    // подквазигруппы, а вердикту достаточно начального множества из двух элементов.
+    verdicts.hasProperSubquasigroups = checkProper && quasigroup.hasSubquasigroups(true, pool);
+    verdicts.hasNonTrivialSubquasigroups = checkNonTrivial && quasigroup.hasSubquasigroups(false, pool);
+    return verdicts;
+}
+
+// Пакетная проверка подквазигрупп для корпусов из множества малых и средних таблиц; check возвращает оба
+// вердикта для всего пакета. Каждая таблица проверяется одной задачей пула (checkSubquasigroups, однопоточный
+// пул на поток): для малых таблиц распараллелить одну проверку нельзя, а независимые таблицы пакета загружают
+// все потоки. Таблицы читаются прямо в ячейки пакета; их буферы переиспользуются между пакетами.
+class SubquasigroupBatchChecker
+{
+    std::vector<CayleyTable> tables;                                 // Таблицы пакета; лишние — запас буферов.
+    std::size_t tableCount = 0;                                      // Таблиц в текущем пакете.
+    std::size_t byteSize = 0;                                        // Суммарный размер ячеек пакета, байт.
+    std::vector<SubquasigroupVerdicts> verdicts;                  // Результат последнего check.
+    std::vector<SubquasigroupAnalysis> witnesses;                    // Свидетели последнего check, если нужны.
+    std::vector<std::unique_ptr<WorkStealingThreadPool>> tablePools; // Однопоточный пул для каждого потока.
+
+public:
+    // Очищает пакет; буферы таблиц сохраняются.
+    void clear()
+    {
+        tableCount = 0;
+        byteSize = 0;
+    }
+
+    std::size_t size() const { return tableCount; }
+    std::size_t getByteSize() const { return byteSize; }
+
+    // Возвращает: Буфер следующей таблицы пакета; заполненная таблица добавляется в пакет вызовом commitNext.
+    CayleyTable &getNext()
+    {
+        if (tableCount == tables.size())
+        {
+            tables.emplace_back();
+        }
+        return tables[tableCount];
+    }
+
+    // Добавляет в пакет таблицу, записанную в буфер getNext.
+    void commitNext()
+    {
+        byteSize += tables[tableCount++].getByteSize();
+    }
+
+    // Возвращает: Представление таблицы с номером index.
+    CayleyTableView getTable(std::size_t index) const { return tables[index]; }
+
+    // Проверяет все таблицы пакета, по задаче пула на таблицу.
+    // Параметры:
+    //   pool: Пул потоков.
+    //   checkProper, checkNonTrivial: Нужные вердикты.
+    //   collectsWitnesses: Сохранить свидетелей для getWitnesses.
+    // Возвращает: Вердикты в порядке добавления таблиц.
+    // Выбрасывает: Исключение первой упавшей проверки; остальные задачи пакета при этом отменяются.
+    const std::vector<SubquasigroupVerdicts> &check(WorkStealingThreadPool &pool, bool checkProper,
+                                                    bool checkNonTrivial, bool collectsWitnesses = false)
+    {
+        while (tablePools.size() < pool.getWorkerCount())
+        {
+            tablePools.push_back(std::make_unique<WorkStealingThreadPool>(1));
+        }
+        witnesses.assign(collectsWitnesses ? tableCount : 0, SubquasigroupAnalysis());
+        auto analyze = [&](std::size_t index, unsigned worker)
+        {
+            QUASIGROUP_TIME_PHASE(analyze);
+            return checkSubquasigroups(getTable(index), checkProper, checkNonTrivial, *tablePools[worker],
+                                       collectsWitnesses ? &witnesses[index] : nullptr);
+        };
+        verdicts.assign(tableCount, SubquasigroupVerdicts());
+        pool.run(tableCount, [&](std::size_t index, unsigned worker)
+                 {
+                     verdicts[index] = analyze(index, worker);
+                     return true; });
+        return verdicts;
+    }
+
+    // Возвращает: Свидетелей таблицы index из последнего check с collectsWitnesses.
+    const SubquasigroupAnalysis &getWitnesses(std::size_t index) const { return witnesses[index]; }
+};
+
+// Реализация isLatinSquare для конкретной ширины ячейки: один последовательный проход по строкам.
+// Каждое значение ячейки добавляется битом в маску своей строки и в маску своего столбца. Если все n значений
+// строки меньше n, а объединение их битов полно, то по принципу Дирихле каждое встречается ровно один раз;
+// то же для столбцов по маскам, накопленным за проход. Поэтому столбцы не читаются с шагом n, во внутреннем
+// цикле нет ветвлений, а проверка диапазона (максимум строки) векторизуется компилятором.
+template <class Cells>
+bool isLatinSquareIn(const Cells &cells)
+{
+    int order = cells.order;
+    int wordCount = (order + 63) / 64;
+    ScratchArena::Scope scratchScope(getThreadScratchArena());
+    ScratchVector<std::uint64_t> columnMasks(static_cast<std::size_t>(order) * wordCount, 0, getThreadScratchArena());
+    ScratchVector<std::uint64_t> rowMask(wordCount, 0, getThreadScratchArena());
+    ScratchVector<std::uint64_t> fullMask(wordCount, ~0ull, getThreadScratchArena());
+    if (order % 64 != 0)
+    {
+        fullMask.back() = (1ull << (order % 64)) - 1;
+    }
+    for (int row = 0; row < order; ++row)
+    {
+        const auto *rowCells = cells.cells + static_cast<std::size_t>(row) * order;
+        auto maximum = rowCells[0];
+        for (int column = 1; column < order; ++column)
+        {
+            maximum = std::max(maximum, rowCells[column]);
+        }
+        if (static_cast<long long>(maximum) >= order)
+        {
+            return false;
+        }
+        std::fill(rowMask.begin(), rowMask.end(), 0);
+        std::uint64_t *columnMask = columnMasks.data();
+        for (int column = 0; column < order; ++column, columnMask += wordCount)
+        {
+            unsigned value = rowCells[column];
+            std::uint64_t bit = 1ull << (value & 63);
+            rowMask[value >> 6] |= bit;
+            columnMask[value >> 6] |= bit;
+        }
+        if (rowMask != fullMask)
+        {
+            return false;
+        }
+    }
+    for (int column = 0; column < order; ++column)
+    {
+        if (!std::equal(fullMask.begin(), fullMask.end(), columnMasks.begin() + static_cast<std::size_t>(column) * wordCount))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Проверяет, является ли таблица латинским квадратом.
+// Проверяет, что каждый элемент встречается ровно один раз в каждой строке и столбце.
+// Параметр table: Таблица для проверки.
+// Возвращает: true, если таблица — латинский квадрат, false — иначе.
+bool isLatinSquare(CayleyTableView table)
+{
+    if (table.getOrder() == 0)
+    {
+        return true;
+    }
+    return table.visitCells([](const auto &cells) { return isLatinSquareIn(cells); });
+}
+
+// Проверяет таблицу перед анализом: прочитанную из файла или введенную вручную и сгенерированную.
+// Параметр table: Таблица Кэли.
+// Выбрасывает: std::runtime_error, если таблица не является латинским квадратом (или элемент вне [0, n-1]).
+void validateLatinSquare(CayleyTableView table)
+{
+    if (!isLatinSquare(table))
+    {
+        throw std::runtime_error("Таблица Кэли не является латинским квадратом");
+    }
+}
+
+// Двоичный формат таблицы Кэли (.qgb), все поля little-endian:
+//   0: магическое число "QGTABLE\0" (8 байт)
+//   8: версия формата (uint32, сейчас 1)
+//  12: ширина ячейки в байтах (uint32, равна CayleyTable::selectCellWidth(order))
+//  16: порядок (uint32)
+//  20: зарезервировано (uint32, 0)
+//  24: контрольная сумма FNV-1a (uint64) упакованных ячеек
+//  32: ячейки построчно, order * order * ширина байт
+// Заголовок кратен 8 байтам, поэтому ячейки в отображенном файле выровнены и используются без копирования.
+constexpr char binaryCayleyTableMagic[8] = {'Q', 'G', 'T', 'A', 'B', 'L', 'E', '\0'};
+constexpr std::uint32_t binaryCayleyTableVersion = 1;
+constexpr std::size_t binaryCayleyTableHeaderSize = 32;
+
+// Заголовок двоичного файла таблицы после разбора.
+struct BinaryCayleyTableHeader
+{
+    int order = 0;               // Порядок таблицы.
+    std::uint64_t checksum = 0;  // Контрольная сумма ячеек.
+};
+
+// Возвращает: true, если байты числа в памяти идут от младшего к старшему (формат .qgb хранит ячейки так же).
+bool isLittleEndianHost()
+{
+    const std::uint16_t probe = 1;
+    unsigned char firstByte;
+    std::memcpy(&firstByte, &probe, 1);
+    return firstByte == 1;
+}
+
+// Читает беззнаковое little-endian число из byteCount байт.
+std::uint64_t loadLittleEndian(const unsigned char *bytes, int byteCount)
+{
+    std::uint64_t value = 0;
+    for (int index = byteCount - 1; index >= 0; --index)
+    {
+        value = (value << 8) | bytes[index];
+    }
+    return value;
+}
+
+// Записывает младшие byteCount байт числа в порядке little-endian.
+void storeLittleEndian(unsigned char *bytes, std::uint64_t value, int byteCount)
+{
+    for (int index = 0; index < byteCount; ++index)
+    {
+        bytes[index] = static_cast<unsigned char>(value >> (8 * index));
+    }
+}
+
+// Вычисляет контрольную сумму FNV-1a (64 бита).
+// Параметры:
+//   bytes: Начало данных.
+//   size: Размер данных в байтах.
+// Возвращает: Значение хеша.
+std::uint64_t computeFnv1a64(const void *bytes, std::size_t size)
+{
+    const unsigned char *data = static_cast<const unsigned char *>(bytes);
+    std::uint64_t hash = 14695981039346656037ull;
+    for (std::size_t index = 0; index < size; ++index)
+    {
+        hash = (hash ^ data[index]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// Проверяет, является ли путь файлом двоичного формата по расширению .qgb.
+bool hasBinaryCayleyTableExtension(const std::string &fileName)
+{
+    const std::string extension = ".qgb";
+    return fileName.size() >= extension.size() &&
+           fileName.compare(fileName.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+// Разбирает заголовок двоичного файла таблицы.
+// Параметры:
+//   bytes: Первые binaryCayleyTableHeaderSize байт файла.
+//   fileSize: Полный размер файла в байтах.
+// Возвращает: Порядок и контрольную сумму.
+// Выбрасывает: std::runtime_error при чужом магическом числе, неизвестной версии, некорректных порядке
+//              или ширине ячейки и при размере файла, не совпадающем с заголовком.
+BinaryCayleyTableHeader parseBinaryCayleyTableHeader(const unsigned char *bytes, std::size_t fileSize)
+{
+    auto readUnsigned = [&](std::size_t offset, int byteCount) { return loadLittleEndian(bytes + offset, byteCount); };
+    if (fileSize < binaryCayleyTableHeaderSize ||
+        std::memcmp(bytes, binaryCayleyTableMagic, sizeof(binaryCayleyTableMagic)) != 0)
+    {
+        throw std::runtime_error("Файл не является двоичной таблицей Кэли");
+    }
+    if (readUnsigned(8, 4) != binaryCayleyTableVersion)
+    {
+        throw std::runtime_error("Неподдерживаемая версия двоичной таблицы Кэли");
+    }
+    std::uint64_t order = readUnsigned(16, 4);
+    if (order == 0 || order > static_cast<std::uint64_t>(std::numeric_limits<int>::max()))
+    {
+        throw std::runtime_error("Некорректный порядок квазигруппы в файле");
+    }
+    if (readUnsigned(12, 4) != static_cast<std::uint64_t>(CayleyTable::selectCellWidth(static_cast<int>(order))))
+    {
+        throw std::runtime_error("Некорректная ширина ячейки двоичной таблицы Кэли");
+    }
+    BinaryCayleyTableHeader header;
+    header.order = static_cast<int>(order);
+    header.checksum = readUnsigned(24, 8);
+    std::uint64_t cellBytes = order * order * static_cast<std::uint64_t>(CayleyTable::selectCellWidth(header.order));
+    if (fileSize - binaryCayleyTableHeaderSize != cellBytes)
+    {
+        throw std::runtime_error("Размер двоичной таблицы Кэли не совпадает с заголовком");
+    }
+    return header;
+}
+
+// Проверяет контрольную сумму загруженной двоичной таблицы и то, что она является латинским квадратом.
+// Параметры:
+//   table: Загруженная таблица.
+//   checksum: Контрольная сумма из заголовка.
+// Выбрасывает: std::runtime_error, если сумма не совпадает или таблица не является латинским квадратом.
+void verifyBinaryCayleyTable(CayleyTableView table, std::uint64_t checksum)
+{
+    if (computeFnv1a64(table.data(), table.getByteSize()) != checksum)
+    {
+        throw std::runtime_error("Контрольная сумма двоичной таблицы Кэли не совпадает");
+    }
+    validateLatinSquare(table);
+}
+
+// Читает двоичную таблицу Кэли. На POSIX файл отображается в память (MAP_PRIVATE, копирование при записи),
+// и ячейки таблицы указывают прямо в отображение; иначе, или если mmap не удался, файл читается в буфер.
+// Параметр fileName: Путь к файлу .qgb.
+// Возвращает: Таблицу Кэли; отображение освобождается вместе с последней ее копией.
+// Выбрасывает: std::runtime_error, если файл не удалось открыть или он поврежден.
+CayleyTable readBinaryCayleyTableFromFile(const std::string &fileName)
+{
+    if (!isLittleEndianHost())
+    {
+        throw std::runtime_error("Двоичные таблицы Кэли поддерживаются только на little-endian платформах");
+    }
+#if defined(__unix__) || defined(__APPLE__)
+    int descriptor = open(fileName.c_str(), O_RDONLY);
+    if (descriptor < 0)
+    {
+        throw std::runtime_error("Не удалось открыть файл");
+    }
+    struct stat fileStatus;
+    void *mapping = MAP_FAILED;
+    std::size_t fileSize = 0;
+    if (fstat(descriptor, &fileStatus) == 0 && fileStatus.st_size > 0)
+    {
+        fileSize = static_cast<std::size_t>(fileStatus.st_size);
+        mapping = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, descriptor, 0);
+    }
+    close(descriptor);
+    if (mapping != MAP_FAILED)
+    {
+        std::shared_ptr<void> owner(mapping, [fileSize](void *memory) { munmap(memory, fileSize); });
+        unsigned char *bytes = static_cast<unsigned char *>(mapping);
+        BinaryCayleyTableHeader header = parseBinaryCayleyTableHeader(bytes, fileSize);
+        CayleyTable table = CayleyTable::adoptStorage(header.order, std::move(owner), bytes + binaryCayleyTableHeaderSize);
+        verifyBinaryCayleyTable(table, header.checksum);
+        return table;
+    }
+#endif
+    std::ifstream file(fileName, std::ios::binary);
+    if (!file)
+    {
+        throw std::runtime_error("Не удалось открыть файл");
+    }
+    file.seekg(0, std::ios::end);
+    std::size_t streamSize = static_cast<std::size_t>(file.tellg());
+    file.seekg(0);
+    unsigned char headerBytes[binaryCayleyTableHeaderSize] = {};
+    file.read(reinterpret_cast<char *>(headerBytes), sizeof(headerBytes));
+    BinaryCayleyTableHeader header = parseBinaryCayleyTableHeader(headerBytes, file ? streamSize : 0);
+    CayleyTable table(header.order);
+    if (!file.read(static_cast<char *>(table.data()), static_cast<std::streamsize>(table.getByteSize())))
+    {
+        throw std::runtime_error("Не удалось прочитать двоичную таблицу Кэли");
+    }
+    verifyBinaryCayleyTable(table, header.checksum);
+    return table;
+}
+
+// Читает таблицу Кэли из файла для создания квазигруппы.
+// Параметр fileName: Путь к входному файлу.
+// Формат: Двоичный (см. binaryCayleyTableMagic) определяется по магическому числу; иначе текстовый:
+//         первая строка — порядок n, затем n x n целых чисел.
+// Возвращает: Плоскую таблицу Кэли.
+// Выбрасывает: std::runtime_error, если файл не удалось открыть, порядок некорректен,
+//              элемент таблицы выходит за диапазон [0, n-1] или таблица не является латинским квадратом.
+CayleyTable readCayleyTableFromFile(const std::string &fileName)
+{
+    std::ifstream file(fileName);
+    if (!file)
+    {
+        throw std::runtime_error("Не удалось открыть файл");
+    }
+    char magic[sizeof(binaryCayleyTableMagic)] = {};
+    if (file.read(magic, sizeof(magic)) && std::memcmp(magic, binaryCayleyTableMagic, sizeof(magic)) == 0)
+    {
+        file.close();
+        return readBinaryCayleyTableFromFile(fileName);
+    }
+    file.clear();
+    file.seekg(0);
+    int order;
+    if (!(file >> order) || order <= 0)
+    {
+        throw std::runtime_error("Некорректный порядок квазигруппы в файле");
+    }
+    CayleyTable cayleyTable(order);
+    for (int row = 0; row < order; ++row)
+    {
+        for (int column = 0; column < order; ++column)
+        {
+            int value;
+            if (!(file >> value) || value < 0 || value >= order)
+            {
+                throw std::runtime_error("Некорректный элемент таблицы Кэли в файле");
+            }
+            cayleyTable.set(row, column, value);
+        }
+    }
+    validateLatinSquare(cayleyTable);
+    return cayleyTable;
+}
+
+// Читает таблицу Кэли из стандартного ввода, запрашивая значения у пользователя.
+// Запрашивает порядок и каждый элемент таблицы, проверяя корректность ввода.
+// Возвращает: Плоскую таблицу Кэли.
+// Выбрасывает: std::runtime_error, если введенная таблица не является латинским квадратом.
+CayleyTable readCayleyTableFromStandardInput()
+{
+    int order;
+    std::cout << "\nВведите порядок квазигруппы: ";
+    std::cin >> order;
+    CayleyTable cayleyTable(order);
+    std::cout << "\nВведите таблицу Кэли (" << order << "x" << order << "):\n";
+    for (int row = 0; row < order; ++row)
+    {
+        for (int column = 0; column < order; ++column)
+        {
+            int value;
+            std::cout << "(" << row << "," << column << "): ";
+            std::cin >> value;
+            while (value < 0 || value > order - 1)
+            {
+                std::cout << "Элементы должны быть меньше " << order << "\nВведите снова: \n";
+                std::cout << "(" << row << "," << column << "): ";
+                std::cin >> value;
+            }
+            cayleyTable.set(row, column, value);
+        }
+    }
+    validateLatinSquare(cayleyTable);
+    return cayleyTable;
+}
+
+// Записывает таблицу Кэли циклической группы порядка n в буфер вызывающего кода (см. CayleyTable::assignOrder).
+// Операция: x * y = (x + y) mod n.
+// Параметры:
+//   order: Размер группы.
+//   cayleyTable: Таблица для результата.
+void generateCyclicGroupCayleyTable(int order, CayleyTable &cayleyTable)
+{
+    cayleyTable.assignOrder(order);
+    for (int row = 0; row < order; ++row)
+    {
+        for (int column = 0; column < order; ++column)
+        {
+            cayleyTable.set(row, column, (row + column) % order);
+        }
+    }
+}
+
+// Генерирует таблицу Кэли для циклической группы порядка n.
+// Операция: x * y = (x + y) mod n.
+// Параметр order: Размер группы.
+// Возвращает: Плоскую таблицу Кэли.
+CayleyTable generateCyclicGroupCayleyTable(int order)
+{
+    CayleyTable cayleyTable;
+    generateCyclicGroupCayleyTable(order, cayleyTable);
+    return cayleyTable;
+}
+
+// Генерирует случайную перестановку чисел от 0 до n-1.
+// Используется в генерации аффинной квазигруппы для функции f.
+// Параметр order: Размер перестановки.
+// Возвращает: Вектор, представляющий перестановку.
+std::vector<int> generateRandomPermutation(int order)
+{
+    std::vector<int> permutation(order);
+    std::iota(permutation.begin(), permutation.end(), 0);
+    std::shuffle(permutation.begin(), permutation.end(), getRandomNumberGenerator());
+    return permutation;
+}
+
+// Проверяет, что f — перестановка чисел 0..order-1.
+// Параметры:
+//   order: Размер квазигруппы.
+//   permutationFunction: Проверяемая функция.
+// Выбрасывает: std::invalid_argument, если f не является перестановкой.
+void validatePermutationFunction(int order, const std::vector<int> &permutationFunction)
+{
+    std::vector<bool> seenValues(order, false);
+    if (static_cast<int>(permutationFunction.size()) != order ||
+        !std::all_of(permutationFunction.begin(), permutationFunction.end(), [&](int value)
+                     { return value >= 0 && value < order && !seenValues[value] && (seenValues[value] = true); }))
+    {
+        throw std::invalid_argument("f должна быть перестановкой чисел 0..n-1");
+    }
+}
+
+// Проверяет параметры аффинной квазигруппы x * y = (alpha * x + beta * f(y) + c) mod n.
+// Параметры:
+//   order: Размер квазигруппы.
+//   coefficientAlpha, coefficientBeta: Коэффициенты, взаимно простые с order.
+//   constantC: Константа (0 <= c < order).
+//   permutationFunction: Перестановка f чисел 0..order-1.
+// Выбрасывает: std::invalid_argument при некорректных параметрах.
+void validateAffineQuasigroupParameters(int order, int coefficientAlpha, int coefficientBeta, int constantC,
+                                        const std::vector<int> &permutationFunction)
+{
+    if (order <= 0 || computeGreatestCommonDivisor(coefficientAlpha, order) != 1 ||
+        computeGreatestCommonDivisor(coefficientBeta, order) != 1)
+    {
+        throw std::invalid_argument("alpha и beta должны быть взаимно простыми с порядком");
+    }
+    if (constantC < 0 || constantC >= order)
+    {
+        throw std::invalid_argument("c должно быть в диапазоне [0, n-1]");
+    }
+    validatePermutationFunction(order, permutationFunction);
+}
+
+// Заполняет существующую таблицу аффинной квазигруппы по слагаемым строк и столбцов.
+// Параметры:
+//   cayleyTable: Таблица порядка n, перезаписываемая на месте.
+//   rowTerms: alpha * x mod n для каждой строки x.
+//   columnTerms: beta * f(y) mod n для каждого столбца y.
+//   constantC: Константа (0 <= c < n).
+// Каждая ячейка вычисляется двумя сложениями с условным вычитанием n, без деления.
+void fillAffineQuasigroupCayleyTable(CayleyTable &cayleyTable, const std::vector<int> &rowTerms,
+                                     const std::vector<int> &columnTerms, int constantC)
+{
+    int order = cayleyTable.getOrder();
+    cayleyTable.visitMutableCells([&](auto cells)
+                                  {
+                                      for (int row = 0; row < order; ++row)
+                                      {
+                                          int rowTerm = rowTerms[row] + constantC;
+                                          rowTerm -= rowTerm >= order ? order : 0;
+                                          for (int column = 0; column < order; ++column)
+                                          {
+                                              int value = rowTerm + columnTerms[column];
+                                              cells.set(row, column, value >= order ? value - order : value);
+                                          }
+                                      } });
+}
+
+// Вычисляет слагаемые coefficient * values[i] mod n для заполнения аффинной таблицы.
+// Параметры:
+//   terms: Результат, размер n.
+//   coefficient: Коэффициент alpha или beta.
+//   values: Аргументы (номера строк или значения f); пусто — тождественные 0..n-1.
+void computeAffineTerms(std::vector<int> &terms, int coefficient, const std::vector<int> &values)
+{
+    long long order = static_cast<long long>(terms.size());
+    long long reduced = (coefficient % order + order) % order;
+    for (std::size_t index = 0; index < terms.size(); ++index)
+    {
+        long long argument = values.empty() ? static_cast<long long>(index) : values[index];
+        terms[index] = static_cast<int>(reduced * argument % order);
+    }
+}
+
+// Заполняет на месте таблицу аффинной квазигруппы x * y = (alpha * x + beta * f(y) + c) mod n.
+// Параметры:
+//   cayleyTable: Таблица порядка n, перезаписываемая без выделения памяти под ячейки.
+//   coefficientAlpha, coefficientBeta, constantC, permutationFunction: См. validateAffineQuasigroupParameters.
+// Выбрасывает: std::invalid_argument при некорректных параметрах.
+void fillAffineQuasigroupCayleyTable(CayleyTable &cayleyTable, int coefficientAlpha, int coefficientBeta,
+                                     int constantC, const std::vector<int> &permutationFunction)
+{
+    int order = cayleyTable.getOrder();
+    validateAffineQuasigroupParameters(order, coefficientAlpha, coefficientBeta, constantC, permutationFunction);
+    std::vector<int> rowTerms(order), columnTerms(order);
+    computeAffineTerms(rowTerms, coefficientAlpha, {});
+    computeAffineTerms(columnTerms, coefficientBeta, permutationFunction);
+    fillAffineQuasigroupCayleyTable(cayleyTable, rowTerms, columnTerms, constantC);
+}
+
+// Вариант generateAffineQuasigroupCayleyTable, записывающий таблицу в буфер вызывающего кода
+// (см. CayleyTable::assignOrder).
+// Параметры: См. validateAffineQuasigroupParameters; cayleyTable — таблица для результата.
+// Выбрасывает: std::invalid_argument при некорректных параметрах; таблица при этом не меняется.
+void generateAffineQuasigroupCayleyTable(int order, int coefficientAlpha, int coefficientBeta, int constantC,
+                                         const std::vector<int> &permutationFunction, CayleyTable &cayleyTable)
+{
+    validateAffineQuasigroupParameters(order, coefficientAlpha, coefficientBeta, constantC, permutationFunction);
+    cayleyTable.assignOrder(order);
+    fillAffineQuasigroupCayleyTable(cayleyTable, coefficientAlpha, coefficientBeta, constantC, permutationFunction);
+}
+
+// Генерирует таблицу Кэли аффинной квазигруппы по заданным параметрам, без обращения к консоли.
+// Операция: x * y = (alpha * x + beta * f(y) + c) mod n, где f — перестановка.
+// Параметры: См. validateAffineQuasigroupParameters.
+// Возвращает: Плоскую таблицу Кэли.
+// Выбрасывает: std::invalid_argument при некорректных параметрах.
+CayleyTable generateAffineQuasigroupCayleyTable(int order, int coefficientAlpha, int coefficientBeta, int constantC,
+                                                const std::vector<int> &permutationFunction)
+{
+    CayleyTable cayleyTable;
+    generateAffineQuasigroupCayleyTable(order, coefficientAlpha, coefficientBeta, constantC, permutationFunction,
+                                        cayleyTable);
+    return cayleyTable;
+}
+
+// Перебирает все аффинные квазигруппы заданного порядка с фиксированной перестановкой f:
+// alpha и beta — все коэффициенты из [1, n-1], прошедшие фильтр computeGreatestCommonDivisor, c — все из [0, n-1].
+// Одна таблица заполняется на месте для каждой комбинации; слагаемые строк и столбцов пересчитываются
+// только при смене alpha и beta соответственно.
+// Параметры:
+//   order: Размер квазигруппы.
+//   permutationFunction: Перестановка f.
+//   visitor: visitor(alpha, beta, c, const CayleyTable &) возвращает false, чтобы остановить перебор.
+//   firstPair, endPair: Посещаются только пары (alpha, beta) с номерами [firstPair, endPair) в порядке перебора
+//                       (шард пакетного режима); таблицы остальных пар не заполняются.
+// Возвращает: Число посещенных комбинаций.
+// Выбрасывает: std::invalid_argument, если f не является перестановкой.
+template <class Visitor>
+long long sweepAffineQuasigroups(int order, const std::vector<int> &permutationFunction, Visitor &&visitor,
+                                 long long firstPair = 0, long long endPair = std::numeric_limits<long long>::max())
+{
+    validateAffineQuasigroupParameters(order, 1, 1, 0, permutationFunction);
+    CayleyTable cayleyTable(order);
+    std::vector<int> rowTerms(order), columnTerms(order);
+    long long visitedCount = 0, pairIndex = 0;
+    int firstCoefficient = order == 1 ? 0 : 1;
+    for (int coefficientAlpha = firstCoefficient; coefficientAlpha < order && pairIndex < endPair; ++coefficientAlpha)
+    {
+        if (computeGreatestCommonDivisor(coefficientAlpha, order) != 1)
+        {
+            continue;
+        }
+        computeAffineTerms(rowTerms, coefficientAlpha, {});
+        for (int coefficientBeta = firstCoefficient; coefficientBeta < order && pairIndex < endPair; ++coefficientBeta)
+        {
+            if (computeGreatestCommonDivisor(coefficientBeta, order) != 1 || pairIndex++ < firstPair)
+            {
+                continue;
+            }
+            computeAffineTerms(columnTerms, coefficientBeta, permutationFunction);
+            for (int constantC = 0; constantC < order; ++constantC)
+            {
+                fillAffineQuasigroupCayleyTable(cayleyTable, rowTerms, columnTerms, constantC);
+                ++visitedCount;
+                if (!visitor(coefficientAlpha, coefficientBeta, constantC, static_cast<const CayleyTable &>(cayleyTable)))
+                {
+                    return visitedCount;
+                }
+            }
+        }
+    }
+    return visitedCount;
+}
+
+// Выбирает случайный коэффициент из [1, n-1], взаимно простой с n (для n = 1 — единственный вариант 0).
+// Параметр order: Модуль n.
+// Возвращает: Коэффициент, пригодный для alpha или beta аффинной квазигруппы.
+int selectRandomCoprimeCoefficient(int order)
+{
+    if (order == 1)
+    {
+        return 0;
+    }
+    std::uniform_int_distribution<int> distribution(1, order - 1);
+    int coefficient;
+    do
+    {
+        coefficient = distribution(getRandomNumberGenerator());
+    } while (computeGreatestCommonDivisor(coefficient, order) != 1);
+    return coefficient;
+}
+
+// Аффинная квазигруппа x * y = (alpha * x + beta * y + c) mod n (f — тождественная), заданная формулой без таблицы.
+// Операция вычисляется арифметически за O(1) памяти; циклическая группа Z_n — частный случай alpha = beta = 1, c = 0.
+// Подквазигруппа, порожденная элементом s, — смежный класс s + g * Z_n, где g = gcd((alpha + beta - 1) * s + c, n):
+// он замкнут, так как (s + u) * (s + v) = s + ((alpha + beta - 1) * s + c) + alpha * u + beta * v, и наименьший,
+// так как содержит s и s * s. Поэтому анализ не строит таблицу и доступен для порядков в миллионы.
+class AffineFormulaQuasigroup
+{
+    int order;            // Порядок n.
+    int coefficientAlpha; // alpha, взаимно простой с n, приведенный к [0, n-1].
+    int coefficientBeta;  // beta, взаимно простой с n, приведенный к [0, n-1].
+    int constantC;        // c из [0, n-1].
+
+public:
+    // Конструирует квазигруппу по параметрам формулы.
+    // Параметры:
+    //   order: Порядок n.
+    //   coefficientAlpha, coefficientBeta: Коэффициенты, взаимно простые с n (приводятся по модулю n).
+    //   constantC: Сдвиг из [0, n-1].
+    // Выбрасывает: std::invalid_argument при некорректных параметрах.
+    AffineFormulaQuasigroup(int order, int coefficientAlpha, int coefficientBeta, int constantC)
+        : order(order), coefficientAlpha(0), coefficientBeta(0), constantC(constantC)
+    {
+        if (order <= 0)
+        {
+            throw std::invalid_argument("Порядок квазигруппы должен быть положительным");
+        }
+        this->coefficientAlpha = (coefficientAlpha % order + order) % order;
+        this->coefficientBeta = (coefficientBeta % order + order) % order;
+        if (computeGreatestCommonDivisor(this->coefficientAlpha, order) != 1 ||
+            computeGreatestCommonDivisor(this->coefficientBeta, order) != 1)
+        {
+            throw std::invalid_argument("alpha и beta должны быть взаимно простыми с порядком");
+        }
+        if (constantC < 0 || constantC >= order)
+        {
+            throw std::invalid_argument("c должно быть в диапазоне [0, n-1]");
+        }
+    }
+
+    // Возвращает: Циклическую группу Z_n (x * y = (x + y) mod n), как generateCyclicGroupCayleyTable.
+    static AffineFormulaQuasigroup cyclicGroup(int order) { return AffineFormulaQuasigroup(order, 1, 1, 0); }
+
+    int getOrder() const { return order; }
+    int getCoefficientAlpha() const { return coefficientAlpha; }
+    int getCoefficientBeta() const { return coefficientBeta; }
+    int getConstantC() const { return constantC; }
+
+    // Вычисляет результат операции без проверки границ.
+    int operator()(int firstElement, int secondElement) const
+    {
+        return static_cast<int>((static_cast<long long>(coefficientAlpha) * firstElement +
+                                 static_cast<long long>(coefficientBeta) * secondElement + constantC) % order);
+    }
+
+    // Вычисляет результат операции квазигруппы для двух элементов.
+    // Параметры:
+    //   firstElement, secondElement: Индексы элементов (от 0 до order-1).
+    // Возвращает: (alpha * firstElement + beta * secondElement + c) mod n.
+    // Выбрасывает: std::out_of_range при некорректных индексах.
+    int applyOperation(int firstElement, int secondElement) const
+    {
+        if (firstElement < 0 || firstElement >= order || secondElement < 0 || secondElement >= order)
+        {
+            throw std::out_of_range("Индексы элементов вне допустимого диапазона");
+        }
+        return (*this)(firstElement, secondElement);
+    }
+
+    // Строит плотную таблицу Кэли той же квазигруппы (для сравнения с анализом по таблице).
+    // Возвращает: Таблицу как у generateAffineQuasigroupCayleyTable с тождественной f.
+    CayleyTable materialize() const
+    {
+        std::vector<int> identityFunction(order);
+        std::iota(identityFunction.begin(), identityFunction.end(), 0);
+        return generateAffineQuasigroupCayleyTable(order, coefficientAlpha, coefficientBeta, constantC, identityFunction);
+    }
+
+    // Проверяет подквазигруппы по параметрам, с тем же результатом, что Quasigroup::hasSubquasigroups
+    // для materialize().
+    bool hasSubquasigroups(bool checkForProperSubquasigroups) const
+    {
+        SubquasigroupAnalysis analysis = analyzeSubquasigroups();
+        return checkForProperSubquasigroups ? analysis.hasProperSubquasigroups : analysis.hasNonTrivialSubquasigroups;
+    }
+
+    // Выполняет обе проверки по параметрам за O(n) времени и n бит памяти. Вердикты и свидетели совпадают
+    // с Quasigroup::analyzeSubquasigroups для materialize(): начальные множества обходятся в том же порядке
+    // (циклы возведения в квадрат x -> (alpha + beta) * x + c от непосещенных элементов), а замыкание
+    // начального множества от s равно порожденному s смежному классу.
+    // Возвращает: Результат анализа со свидетелями.
+    SubquasigroupAnalysis analyzeSubquasigroups() const
+    {
+        SubquasigroupAnalysis analysis;
+        // Первое неидемпотентное (s * s != s) начало цикла — наименьший неидемпотентный элемент:
+        // 0, если c != 0, иначе 1, если alpha + beta != 1 (mod n).
+        int idempotentSlope = static_cast<int>((static_cast<long long>(coefficientAlpha) + coefficientBeta - 1) % order);
+        if (constantC != 0 || idempotentSlope != 0)
+        {
+            analysis.hasNonTrivialSubquasigroups = true;
+            analysis.nonTrivialWitness = generatedSubquasigroup(constantC != 0 ? 0 : 1);
+        }
+        std::vector<bool> visitedElements(order, false);
+        for (int startElement = 0; startElement < order; ++startElement)
+        {
+            if (visitedElements[startElement])
+            {
+                continue;
+            }
+            if (generatedSubquasigroupStep(startElement) > 1)
+            {
+                analysis.hasProperSubquasigroups = true;
+                analysis.properWitness = generatedSubquasigroup(startElement);
+                break;
+            }
+            for (int element = startElement; !visitedElements[element]; element = (*this)(element, element))
+            {
+                visitedElements[element] = true;
+            }
+        }
+        return analysis;
+    }
+
+private:
+    // Возвращает: Шаг g смежного класса s + g * Z_n, порожденного элементом s (n для идемпотента).
+    int generatedSubquasigroupStep(int element) const
+    {
+        int translation = static_cast<int>(
+            ((static_cast<long long>(coefficientAlpha) + coefficientBeta - 1) * element + constantC) % order);
+        return translation == 0 ? order : computeGreatestCommonDivisor(translation, order);
+    }
+
+    // Возвращает: Элементы подквазигруппы, порожденной элементом, по возрастанию.
+    std::vector<int> generatedSubquasigroup(int element) const
+    {
+        int step = generatedSubquasigroupStep(element);
+        std::vector<int> elements;
+        elements.reserve(static_cast<std::size_t>(order / step));
+        for (int member = element % step; member < order; member += step)
+        {
+            elements.push_back(member);
+        }
+        return elements;
+    }
+};
+
+// Конечное поле GF(p^m) с таблицами логарифмов, степеней и логарифмов Зеха, построенными при создании.
+// Элемент кодируется числом 0..p^m-1, цифры которого в системе счисления p — коэффициенты многочлена
+// над GF(p) (младшая цифра — свободный член); для m = 1 это вычеты по модулю p.
+// Умножение — два обращения к таблицам (exp[log a + log b]), сложение — XOR при p = 2,
+// иначе через логарифм Зеха: g^i + g^j = g^(i + zech(j - i)), где zech(k) = log(1 + g^k).
+class GaloisField
+{
+    int characteristic;                  // p.
+    int degree;                          // m.
+    int order;                           // q = p^m.
+    std::vector<int> exponents;          // exponents[k] = g^k для k из [0, 2(q-1)), чтобы не брать остаток.
+    std::vector<int> logarithms;         // logarithms[a] = log_g a для a != 0.
+    std::vector<int> zechLogarithms;     // zechLogarithms[k] = log_g(1 + g^k) или -1, если 1 + g^k = 0.
+    std::vector<int> primitivePolynomial; // Коэффициенты c_0..c_{m-1} многочлена x^m + ... + c_0.
+
+public:
+    // Наибольший поддерживаемый порядок поля: таблицы занимают около 16 байт на элемент.
+    static constexpr int maximumOrder = 1 << 24;
+
+    // Строит поле GF(p^m): находит примитивный многочлен степени m и заполняет таблицы.
+    // Параметры:
+    //   characteristic: Простое p.
+    //   degree: Степень m >= 1.
+    // Выбрасывает: std::invalid_argument, если p не простое, m < 1 или p^m > maximumOrder.
+    GaloisField(int characteristic, int degree) : characteristic(characteristic), degree(degree), order(1)
+    {
+        if (!isPrime(characteristic) || degree < 1)
+        {
+            throw std::invalid_argument("Поле GF(p^m) требует простого p и m >= 1");
+        }
+        for (int power = 0; power < degree; ++power)
+        {
+            if (static_cast<long long>(order) * characteristic > maximumOrder)
+            {
+                throw std::invalid_argument("Порядок поля GF(p^m) не должен превышать 2^24");
+            }
+            order *= characteristic;
+        }
+        buildTables();
+    }
+
+    int getCharacteristic() const { return characteristic; }
+    int getDegree() const { return degree; }
+    int getOrder() const { return order; }
+    const std::vector<int> &getPrimitivePolynomial() const { return primitivePolynomial; }
+
+    int add(int first, int second) const
+    {
+        if (characteristic == 2)
+        {
+            return first ^ second;
+        }
+        if (first == 0 || second == 0)
+        {
+            return first | second;
+        }
+        int firstLogarithm = logarithms[first];
+        int difference = logarithms[second] - firstLogarithm;
+        int zech = zechLogarithms[difference < 0 ? difference + order - 1 : difference];
+        return zech < 0 ? 0 : exponents[firstLogarithm + zech];
+    }
+
+    int negate(int element) const
+    {
+        if (characteristic == 2 || element == 0)
+        {
+            return element;
+        }
+        return exponents[logarithms[element] + (order - 1) / 2];
+    }
+
+    int subtract(int first, int second) const { return add(first, negate(second)); }
+
+    int multiply(int first, int second) const
+    {
+        return first == 0 || second == 0 ? 0 : exponents[logarithms[first] + logarithms[second]];
+    }
+
+    // Возвращает: Обратный элемент; для 0 результат не определен.
+    int inverse(int element) const { return exponents[(order - 1 - logarithms[element]) % (order - 1)]; }
+
+    // Возвращает: Степень e наименьшего подполя GF(p^e), содержащего оба элемента (e делит m).
+    int getGeneratedSubfieldDegree(int first, int second) const
+    {
+        auto multiplicativeOrder = [&](int element)
+        {
+            return element == 0 ? 1 : (order - 1) / computeGreatestCommonDivisor(logarithms[element], order - 1);
+        };
+        long long firstOrder = multiplicativeOrder(first), secondOrder = multiplicativeOrder(second);
+        long long subfieldOrder = 1;
+        for (int subfieldDegree = 1; subfieldDegree <= degree; ++subfieldDegree)
+        {
+            subfieldOrder *= characteristic;
+            if (degree % subfieldDegree == 0 && (subfieldOrder - 1) % firstOrder == 0 &&
+                (subfieldOrder - 1) % secondOrder == 0)
+            {
+                return subfieldDegree;
+            }
+        }
+        return degree;
+    }
+
+    // Возвращает: Элементы подполя GF(p^e), e делит m, в порядке 0, 1, g^k, g^2k, ...
+    std::vector<int> getSubfieldElements(int subfieldDegree) const
+    {
+        long long subfieldOrder = 1;
+        for (int power = 0; power < subfieldDegree; ++power)
+        {
+            subfieldOrder *= characteristic;
+        }
+        int step = static_cast<int>((order - 1) / (subfieldOrder - 1));
+        std::vector<int> elements{0};
+        for (int logarithm = 0; logarithm < order - 1; logarithm += step)
+        {
+            elements.push_back(exponents[logarithm]);
+        }
+        return elements;
+    }
+
+private:
+    static bool isPrime(int number)
+    {
+        if (number < 2)
+        {
+            return false;
+        }
+        for (int divisor = 2; static_cast<long long>(divisor) * divisor <= number; ++divisor)
+        {
+            if (number % divisor == 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Умножает элемент на x по модулю многочлена x^m + c_{m-1} x^{m-1} + ... + c_0 (поразрядно в системе p;
+    // при p = 2 — сдвиг и XOR с кодом многочлена).
+    // Параметры:
+    //   element: Элемент поля.
+    //   coefficients: Коэффициенты c_0..c_{m-1}.
+    //   polynomialCode: Те же коэффициенты, закодированные как элемент.
+    int multiplyByX(int element, const std::vector<int> &coefficients, int polynomialCode) const
+    {
+        int topPlace = order / characteristic;
+        int top = element / topPlace;
+        int shifted = (element % topPlace) * characteristic;
+        if (characteristic == 2)
+        {
+            return top ? shifted ^ polynomialCode : shifted;
+        }
+        int result = 0, place = 1;
+        for (int digit = 0; digit < degree; ++digit, place *= characteristic)
+        {
+            int value = (shifted / place) % characteristic - top * coefficients[digit] % characteristic;
+            result += (value < 0 ? value + characteristic : value) * place;
+        }
+        return result;
+    }
+
+    // Умножает элементы по модулю многочлена схемой Горнера по цифрам второго множителя
+    // (используется только при поиске примитивного многочлена, до построения таблиц).
+    int multiplyElements(int first, int second, const std::vector<int> &coefficients, int polynomialCode) const
+    {
+        int result = 0;
+        for (int place = order / characteristic; place > 0; place /= characteristic)
+        {
+            result = addScaledDigits(multiplyByX(result, coefficients, polynomialCode), first,
+                                     (second / place) % characteristic);
+        }
+        return result;
+    }
+
+    // Вычисляет first + scalar * second поразрядно по модулю p (используется только при построении таблиц).
+    int addScaledDigits(int first, int second, int scalar) const
+    {
+        if (scalar == 0)
+        {
+            return first;
+        }
+        if (characteristic == 2)
+        {
+            return first ^ second;
+        }
+        int result = 0;
+        for (int place = 1; place < order; place *= characteristic)
+        {
+            long long digit = (first / place) % characteristic + static_cast<long long>(scalar) * ((second / place) % characteristic);
+            result += static_cast<int>(digit % characteristic) * place;
+        }
+        return result;
+    }
+
+    // Проверяет, примитивен ли многочлен: x^(q-1) = 1 и x^((q-1)/r) != 1 для каждого простого делителя r числа q - 1.
+    // Для приводимого многочлена обратимых элементов меньше q - 1, поэтому порядок x не может быть равен q - 1.
+    bool isPrimitivePolynomial(const std::vector<int> &coefficients, int polynomialCode,
+                               const std::vector<int> &primeFactors) const
+    {
+        int variable = degree == 1 ? multiplyByX(1, coefficients, polynomialCode) : characteristic;
+        auto power = [&](long long exponent)
+        {
+            int result = 1, base = variable;
+            for (; exponent > 0; exponent >>= 1)
+            {
+                if (exponent & 1)
+                {
+                    result = multiplyElements(result, base, coefficients, polynomialCode);
+                }
+                base = multiplyElements(base, base, coefficients, polynomialCode);
+            }
+            return result;
+        };
+        if (power(order - 1) != 1)
+        {
+            return false;
+        }
+        return std::all_of(primeFactors.begin(), primeFactors.end(),
+                           [&](int factor) { return power((order - 1) / factor) != 1; });
+    }
+
+    // Перебирает многочлены x^m + ... + c_0 с c_0 != 0 до первого примитивного (x — порождающий элемент),
+    // затем строит степени, логарифмы и логарифмы Зеха.
+    void buildTables()
+    {
+        std::vector<int> primeFactors;
+        for (int rest = order - 1, divisor = 2; rest > 1; ++divisor)
+        {
+            if (static_cast<long long>(divisor) * divisor > rest)
+            {
+                divisor = rest;
+            }
+            if (rest % divisor == 0)
+            {
+                primeFactors.push_back(divisor);
+                while (rest % divisor == 0)
+                {
+                    rest /= divisor;
+                }
+            }
+        }
+        std::vector<int> coefficients(degree);
+        int polynomialCode = 0;
+        for (int candidate = 1; candidate < order; ++candidate)
+        {
+            if (candidate % characteristic == 0)
+            {
+                continue;
+            }
+            for (int digit = 0, rest = candidate; digit < degree; ++digit, rest /= characteristic)
+            {
+                coefficients[digit] = rest % characteristic;
+            }
+            // Код многочлена для сдвига при p = 2 и остаток x^m = -(c_{m-1} x^{m-1} + ... + c_0) в общем случае.
+            polynomialCode = candidate;
+            if (isPrimitivePolynomial(coefficients, polynomialCode, primeFactors))
+            {
+                break;
+            }
+        }
+        primitivePolynomial = coefficients;
+        exponents.assign(2 * static_cast<std::size_t>(order - 1) + 1, 0);
+        logarithms.assign(order, 0);
+        int generator = degree == 1 ? multiplyByX(1, coefficients, polynomialCode) : characteristic;
+        for (int logarithm = 0, element = 1; logarithm < order - 1; ++logarithm)
+        {
+            exponents[logarithm] = exponents[logarithm + order - 1] = element;
+            logarithms[element] = logarithm;
+            element = degree == 1 ? multiplyElements(element, generator, coefficients, polynomialCode)
+                                  : multiplyByX(element, coefficients, polynomialCode);
+        }
+        zechLogarithms.assign(order - 1, -1);
+        for (int logarithm = 0; logarithm < order - 1; ++logarithm)
+        {
+            int element = exponents[logarithm];
+            int lowestDigit = element % characteristic;
+            int sum = element - lowestDigit + (lowestDigit + 1) % characteristic;
+            zechLogarithms[logarithm] = sum == 0 ? -1 : logarithms[sum];
+        }
+    }
+};
+
+// Проверяет параметры аффинной квазигруппы x * y = alpha * x + beta * f(y) + c над GF(q).
+// Параметры:
+//   field: Поле.
+//   coefficientAlpha, coefficientBeta: Ненулевые элементы поля.
+//   constantC: Элемент поля.
+//   permutationFunction: Перестановка f элементов 0..q-1.
+// Выбрасывает: std::invalid_argument при некорректных параметрах.
+void validateAffineFieldQuasigroupParameters(const GaloisField &field, int coefficientAlpha, int coefficientBeta,
+                                             int constantC, const std::vector<int> &permutationFunction)
+{
+    int order = field.getOrder();
+    if (coefficientAlpha <= 0 || coefficientAlpha >= order || coefficientBeta <= 0 || coefficientBeta >= order)
+    {
+        throw std::invalid_argument("alpha и beta должны быть ненулевыми элементами поля");
+    }
+    if (constantC < 0 || constantC >= order)
+    {
+        throw std::invalid_argument("c должно быть элементом поля [0, q-1]");
+    }
+    validatePermutationFunction(order, permutationFunction);
+}
+
+// Заполняет таблицу аффинной квазигруппы над GF(q) по заранее вычисленным слагаемым строк и столбцов.
+// Параметры:
+//   cayleyTable: Таблица порядка q (переиспользуется между вызовами).
+//   field: Поле.
+//   rowTerms: alpha * x для каждой строки x.
+//   columnTerms: beta * f(y) + c для каждого столбца y.
+// Ячейка — одно сложение в поле (XOR при p = 2), без деления по модулю.
+void fillAffineFieldQuasigroupCayleyTable(CayleyTable &cayleyTable, const GaloisField &field,
+                                          const std::vector<int> &rowTerms, const std::vector<int> &columnTerms)
+{
+    int order = cayleyTable.getOrder();
+    cayleyTable.visitMutableCells([&](auto cells)
+                                  {
+                                      for (int row = 0; row < order; ++row)
+                                      {
+                                          int rowTerm = rowTerms[row];
+                                          if (field.getCharacteristic() == 2)
+                                          {
+                                              for (int column = 0; column < order; ++column)
+                                              {
+                                                  cells.set(row, column, rowTerm ^ columnTerms[column]);
+                                              }
+                                          }
+                                          else
+                                          {
+                                              for (int column = 0; column < order; ++column)
+                                              {
+                                                  cells.set(row, column, field.add(rowTerm, columnTerms[column]));
+                                              }
+                                          }
+                                      } });
+}
+
+// Вычисляет слагаемые аффинной квазигруппы над полем: rowTerms[x] = alpha * x, columnTerms[y] = beta * f(y) + c.
+void computeAffineFieldTerms(const GaloisField &field, int coefficientAlpha, int coefficientBeta, int constantC,
+                             const std::vector<int> &permutationFunction, std::vector<int> &rowTerms,
+                             std::vector<int> &columnTerms)
+{
+    int order = field.getOrder();
+    rowTerms.resize(order);
+    columnTerms.resize(order);
+    for (int element = 0; element < order; ++element)
+    {
+        rowTerms[element] = field.multiply(coefficientAlpha, element);
+        columnTerms[element] = field.add(field.multiply(coefficientBeta, permutationFunction[element]), constantC);
+    }
+}
+
+// Записывает таблицу Кэли аффинной квазигруппы x * y = alpha * x + beta * f(y) + c над GF(q) в буфер
+// вызывающего кода (см. CayleyTable::assignOrder).
+// Параметры: См. validateAffineFieldQuasigroupParameters; cayleyTable — таблица для результата.
+// Выбрасывает: std::invalid_argument при некорректных параметрах; таблица при этом не меняется.
+void generateAffineFieldQuasigroupCayleyTable(const GaloisField &field, int coefficientAlpha, int coefficientBeta,
+                                              int constantC, const std::vector<int> &permutationFunction,
+                                              CayleyTable &cayleyTable)
+{
+    validateAffineFieldQuasigroupParameters(field, coefficientAlpha, coefficientBeta, constantC, permutationFunction);
+    std::vector<int> rowTerms, columnTerms;
+    computeAffineFieldTerms(field, coefficientAlpha, coefficientBeta, constantC, permutationFunction, rowTerms, columnTerms);
+    cayleyTable.assignOrder(field.getOrder());
+    fillAffineFieldQuasigroupCayleyTable(cayleyTable, field, rowTerms, columnTerms);
+}
+
+// Генерирует таблицу Кэли аффинной квазигруппы x * y = alpha * x + beta * f(y) + c над GF(q).
+// Параметры: См. validateAffineFieldQuasigroupParameters.
+// Возвращает: Плоскую таблицу Кэли порядка q.
+// Выбрасывает: std::invalid_argument при некорректных параметрах.
+CayleyTable generateAffineFieldQuasigroupCayleyTable(const GaloisField &field, int coefficientAlpha, int coefficientBeta,
+                                                     int constantC, const std::vector<int> &permutationFunction)
+{
+    CayleyTable cayleyTable;
+    generateAffineFieldQuasigroupCayleyTable(field, coefficientAlpha, coefficientBeta, constantC, permutationFunction,
+                                             cayleyTable);
+    return cayleyTable;
+}
+
+// Перебирает все аффинные квазигруппы над GF(q) с фиксированной f: alpha, beta из 1..q-1, c из 0..q-1.
+// Таблица переиспользуется, как в sweepAffineQuasigroups.
+// Параметры:
+//   field: Поле.
+//   permutationFunction: Перестановка f.
+//   visitor: Вызывается как visitor(alpha, beta, c, const CayleyTable &); возврат false прекращает перебор.
+//   firstPair, endPair: Номера посещаемых пар (alpha, beta), как в sweepAffineQuasigroups.
+// Возвращает: Число переданных visitor таблиц.
+// Выбрасывает: std::invalid_argument, если f не является перестановкой.
+template <class Visitor>
+long long sweepAffineFieldQuasigroups(const GaloisField &field, const std::vector<int> &permutationFunction,
+                                      Visitor &&visitor, long long firstPair = 0,
+                                      long long endPair = std::numeric_limits<long long>::max())
+{
+    int order = field.getOrder();
+    validatePermutationFunction(order, permutationFunction);
+    CayleyTable cayleyTable(order);
+    std::vector<int> rowTerms, columnTerms;
+    long long visitedCount = 0, pairIndex = 0;
+    for (int coefficientAlpha = 1; coefficientAlpha < order && pairIndex < endPair; ++coefficientAlpha)
+    {
+        for (int coefficientBeta = 1; coefficientBeta < order && pairIndex < endPair; ++coefficientBeta)
+        {
+            if (pairIndex++ < firstPair)
+            {
+                continue;
+            }
+            for (int constantC = 0; constantC < order; ++constantC)
+            {
+                computeAffineFieldTerms(field, coefficientAlpha, coefficientBeta, constantC, permutationFunction,
+                                        rowTerms, columnTerms);
+                fillAffineFieldQuasigroupCayleyTable(cayleyTable, field, rowTerms, columnTerms);
+                ++visitedCount;
+                if (!visitor(coefficientAlpha, coefficientBeta, constantC, static_cast<const CayleyTable &>(cayleyTable)))
+                {
+                    return visitedCount;
+                }
+            }
+        }
+    }
+    return visitedCount;
+}
+
+// Аффинная квазигруппа x * y = alpha * x + beta * y + c над GF(q) (f тождественная), заданная формулой без таблицы.
+// Подквазигруппа, порожденная s, — s + L * t, где t = (alpha + beta - 1) * s + c, а L — подполе, порожденное
+// alpha и beta: множество замкнуто, так как (s + u) * (s + v) = s + t + alpha * u + beta * v, и наименьшее,
+// так как содержит t и все его образы под умножением на alpha и beta. Ее размер — |L| при t != 0 и 1 при t = 0.
+class AffineFieldQuasigroup
+{
+    std::shared_ptr<const GaloisField> field; // Поле (таблицы разделяются между квазигруппами).
+    int coefficientAlpha;                     // alpha.
+    int coefficientBeta;                      // beta.
+    int constantC;                            // c.
+
+public:
+    // Конструирует квазигруппу по параметрам формулы.
+    // Параметры:
+    //   field: Поле GF(q).
+    //   coefficientAlpha, coefficientBeta: Ненулевые элементы поля.
+    //   constantC: Элемент поля.
+    // Выбрасывает: std::invalid_argument при некорректных параметрах.
+    AffineFieldQuasigroup(std::shared_ptr<const GaloisField> field, int coefficientAlpha, int coefficientBeta, int constantC)
+        : field(std::move(field)), coefficientAlpha(coefficientAlpha), coefficientBeta(coefficientBeta), constantC(constantC)
+    {
+        int order = this->field->getOrder();
+        if (coefficientAlpha <= 0 || coefficientAlpha >= order || coefficientBeta <= 0 || coefficientBeta >= order ||
+            constantC < 0 || constantC >= order)
+        {
+            throw std::invalid_argument("alpha и beta должны быть ненулевыми элементами поля, c — элементом поля");
+        }
+    }
+
+    int getOrder() const { return field->getOrder(); }
+    const GaloisField &getField() const { return *field; }
+
+    // Вычисляет результат операции без проверки границ.
+    int operator()(int firstElement, int secondElement) const
+    {
+        return field->add(field->add(field->multiply(coefficientAlpha, firstElement),
+                                     field->multiply(coefficientBeta, secondElement)),
+                          constantC);
+    }
+
+    // Вычисляет результат операции квазигруппы для двух элементов.
+    // Выбрасывает: std::out_of_range при некорректных индексах.
+    int applyOperation(int firstElement, int secondElement) const
+    {
+        int order = getOrder();
+        if (firstElement < 0 || firstElement >= order || secondElement < 0 || secondElement >= order)
+        {
+            throw std::out_of_range("Индексы элементов вне допустимого диапазона");
+        }
+        return (*this)(firstElement, secondElement);
+    }
+
+    // Строит плотную таблицу Кэли той же квазигруппы.
+    CayleyTable materialize() const
+    {
+        std::vector<int> identityFunction(getOrder());
+        std::iota(identityFunction.begin(), identityFunction.end(), 0);
+        return generateAffineFieldQuasigroupCayleyTable(*field, coefficientAlpha, coefficientBeta, constantC,
+                                                        identityFunction);
+    }
+
+    bool hasSubquasigroups(bool checkForProperSubquasigroups) const
+    {
+        SubquasigroupAnalysis analysis = analyzeSubquasigroups();
+        return checkForProperSubquasigroups ? analysis.hasProperSubquasigroups : analysis.hasNonTrivialSubquasigroups;
+    }
+
+    // Выполняет обе проверки по параметрам, с теми же вердиктами и свидетелями, что
+    // Quasigroup::analyzeSubquasigroups для materialize(): начала циклов возведения в квадрат обходятся
+    // в том же порядке, а замыкание начального множества от s равно s + L * t.
+    SubquasigroupAnalysis analyzeSubquasigroups() const
+    {
+        SubquasigroupAnalysis analysis;
+        int order = getOrder();
+        std::vector<int> subfield = field->getSubfieldElements(field->getGeneratedSubfieldDegree(coefficientAlpha,
+                                                                                                  coefficientBeta));
+        int slope = field->subtract(field->add(coefficientAlpha, coefficientBeta), 1);
+        auto translation = [&](int element) { return field->add(field->multiply(slope, element), constantC); };
+        auto generatedSubquasigroup = [&](int element)
+        {
+            int generator = translation(element);
+            std::vector<int> elements{element};
+            if (generator != 0)
+            {
+                elements.clear();
+                for (int scalar : subfield)
+                {
+                    elements.push_back(field->add(element, field->multiply(scalar, generator)));
+                }
+                std::sort(elements.begin(), elements.end());
+            }
+            return elements;
+        };
+        // Первое неидемпотентное начало цикла — наименьший неидемпотентный элемент: 0 при c != 0, иначе 1.
+        if (constantC != 0 || slope != 0)
+        {
+            analysis.hasNonTrivialSubquasigroups = true;
+            analysis.nonTrivialWitness = generatedSubquasigroup(constantC != 0 ? 0 : 1);
+        }
+        bool isSubfieldProper = static_cast<int>(subfield.size()) < order;
+        std::vector<bool> visitedElements(order, false);
+        for (int startElement = 0; startElement < order; ++startElement)
+        {
+            if (visitedElements[startElement])
+            {
+                continue;
+            }
+            if ((isSubfieldProper || translation(startElement) == 0) && order > 1)
+            {
+                analysis.hasProperSubquasigroups = true;
+                analysis.properWitness = generatedSubquasigroup(startElement);
+                break;
+            }
+            for (int element = startElement; !visitedElements[element]; element = (*this)(element, element))
+            {
+                visitedElements[element] = true;
+            }
+        }
+        return analysis;
+    }
+};
+
+// Генерирует таблицу Кэли для аффинной квазигруппы.
+// Операция: x * y = (alpha * x + beta * f(y) + c) mod n, где f — перестановка.
+// Параметр order: Размер квазигруппы.
+// Запрашивает alpha, beta (должны быть взаимно простыми с n) и c (0 <= c < n).
+// Возвращает: Плоскую таблицу Кэли.
+CayleyTable generateAffineQuasigroupCayleyTable(int order)
+{
+    int coefficientAlpha, coefficientBeta, constantC;
+    std::cout << "Введите коэффициент alpha (должен быть взаимно простым с " << order << "): ";
+    std::cin >> coefficientAlpha;
+    while (computeGreatestCommonDivisor(coefficientAlpha, order) != 1)
+    {
+        std::cout << "alpha должен быть взаимно простым с " << order << ". Введите снова: ";
+        std::cin >> coefficientAlpha;
+    }
+    std::cout << "Введите коэффициент beta (должен быть взаимно простым с " << order << "): ";
+    std::cin >> coefficientBeta;
+    while (computeGreatestCommonDivisor(coefficientBeta, order) != 1)
+    {
+        std::cout << "beta должен быть взаимно простым с " << order << ". Введите снова: ";
+        std::cin >> coefficientBeta;
+    }
+    std::cout << "Введите константу c (0 <= c < " << order << "): ";
+    std::cin >> constantC;
+    while (constantC < 0 || constantC >= order)
+    {
+        std::cout << "c должно быть в диапазоне [0, " << order - 1 << "]. Введите снова: ";
+        std::cin >> constantC;
+    }
+
+    auto permutationFunction = generateRandomPermutation(order);
+    std::cout << "Сгенерированная перестановка f: ";
+    for (int value : permutationFunction)
+    {
+        std::cout << value << ' ';
+    }
+    std::cout << "\n";
+
+    return generateAffineQuasigroupCayleyTable(order, coefficientAlpha, coefficientBeta, constantC, permutationFunction);
+}
+
+// Генерирует таблицу Кэли с помощью метода последовательного графа замен.
+// Создает латинский квадрат, последовательно заполняя строки с учетом доступных символов.
+// Доступность символов в столбцах и в строке хранится битовыми масками из 64-битных слов:
+// допустимые символы столбца находятся одним AND на слово, случайный символ выбирается через popcount.
+// Параметр order: Размер квазигруппы.
+// Возвращает: Плоскую таблицу Кэли.
+class SequentialReplacementGraphGenerator
+{
+    // Рабочее состояние генератора и его строк лежит в арене потока. Генератор создается только внутри
+    // generate, после открытия области арены, поэтому области остаются вложенными как области видимости.
+    int order;                                       // Порядок квазигруппы.
+    int wordCount;                                   // Число 64-битных слов в маске символов.
+    CayleyTable *cayleyTable = nullptr;              // Таблица вызывающего кода, заполняемая построчно.
+    ScratchVector<std::uint64_t> availableInColumns; // Маски доступных символов, по wordCount слов на столбец.
+    ScratchVector<std::uint64_t> availableSymbols;   // Маска всех символов (0 до order-1).
+    ScratchVector<int> firstColumnOfSymbol;          // Первая позиция символа в текущей строке или -1.
+    ScratchVector<int> secondColumnOfSymbol;         // Вторая позиция символа (во время цепочки замен) или -1.
+
+public:
+    // Генерирует таблицу Кэли, заполняя строки с помощью метода графа замен.
+    // Параметры:
+    //   order: Размер квазигруппы.
+    //   table: Таблица для результата (см. CayleyTable::assignOrder).
+    static void generate(int order, CayleyTable &table)
+    {
+        ScratchArena::Scope scratchScope(getThreadScratchArena());
+        SequentialReplacementGraphGenerator generator(order);
+        generator.fillTable(table);
+    }
+
+private:
+    // Инициализирует генератор для квазигруппы заданного порядка.
+    // Параметр order: Размер квазигруппы.
+    // Заполняет маску символов и маски доступных символов для столбцов.
+    explicit SequentialReplacementGraphGenerator(int order)
+        : order(order), wordCount((order + 63) / 64), availableInColumns(getThreadScratchArena()), availableSymbols(wordCount, 0, getThreadScratchArena()),
+          firstColumnOfSymbol(order, -1, getThreadScratchArena()), secondColumnOfSymbol(order, -1, getThreadScratchArena())
+    {
+        availableInColumns.reserve(static_cast<std::size_t>(order) * wordCount);
+        for (int symbol = 0; symbol < order; ++symbol)
+        {
+            setBit(availableSymbols.data(), symbol);
+        }
+        for (int column = 0; column < order; ++column)
+        {
+            availableInColumns.insert(availableInColumns.end(), availableSymbols.begin(), availableSymbols.end());
+        }
+    }
+
+    // Заполняет таблицу строка за строкой; генератор одноразовый.
+    // Параметр table: Таблица для результата (см. CayleyTable::assignOrder).
+    void fillTable(CayleyTable &table)
+    {
+        table.assignOrder(order);
+        cayleyTable = &table;
+        for (int row = 0; row < order; ++row)
+        {
+            generateRow(row);
+        }
+        cayleyTable = nullptr;
+    }
+
+    static bool testBit(const std::uint64_t *words, int symbol) { return (words[symbol >> 6] >> (symbol & 63)) & 1U; }
+    static void setBit(std::uint64_t *words, int symbol) { words[symbol >> 6] |= std::uint64_t{1} << (symbol & 63); }
+    static void clearBit(std::uint64_t *words, int symbol) { words[symbol >> 6] &= ~(std::uint64_t{1} << (symbol & 63)); }
+
+    std::uint64_t *columnBits(ScratchVector<std::uint64_t> &masks, int column)
+    {
+        return masks.data() + static_cast<std::size_t>(column) * wordCount;
+    }
+
+    // Обратный индекс строки: символ -> позиции. Во время цепочки замен символ может временно
+    // стоять в двух позициях, поэтому хранятся две позиции по возрастанию.
+    // Возвращает: Первую позицию символа или rowSize, если символа нет в строке (как std::find).
+    int findSymbol(int symbol, int rowSize) const
+    {
+        return firstColumnOfSymbol[symbol] < 0 ? rowSize : firstColumnOfSymbol[symbol];
+    }
+
+    void addSymbolPosition(int symbol, int column)
+    {
+        int &first = firstColumnOfSymbol[symbol], &second = secondColumnOfSymbol[symbol];
+        if (first < 0)
+        {
+            first = column;
+        }
+        else if (column < first)
+        {
+            second = first;
+            first = column;
+        }
+        else
+        {
+            second = column;
+        }
+    }
+
+    void removeSymbolPosition(int symbol, int column)
+    {
+        int &first = firstColumnOfSymbol[symbol], &second = secondColumnOfSymbol[symbol];
+        if (first == column)
+        {
+            first = second;
+        }
+        second = -1;
+    }
+
+    // Записывает символ в позицию строки, поддерживая обратный индекс.
+    void placeSymbol(ScratchVector<int> &row, int column, int symbol)
+    {
+        removeSymbolPosition(row[column], column);
+        row[column] = symbol;
+        addSymbolPosition(symbol, column);
+    }
+
+    // Генерирует одну строку таблицы Кэли, выбирая символы, чтобы сохранить свойства латинского квадрата.
+    // Рабочие маски строки берутся из арены и освобождаются в конце строки.
+    // Параметр rowIndex: Номер заполняемой строки таблицы.
+    void generateRow(int rowIndex)
+    {
+        ScratchArena::Scope rowScope(getThreadScratchArena());
+        ScratchVector<std::uint64_t> availableInRow(availableSymbols.begin(), availableSymbols.end(), getThreadScratchArena());
+        ScratchVector<std::uint64_t> initialAvailable(availableInColumns.begin(), availableInColumns.end(),
+                                                      getThreadScratchArena());
+        ScratchVector<std::uint64_t> validSymbols(wordCount, 0, getThreadScratchArena());
+        ScratchVector<int> row(getThreadScratchArena());
+        row.reserve(order);
+        int currentColumn = 0;
+        while (currentColumn < order)
+        {
+            std::uint64_t *available = columnBits(availableInColumns, currentColumn);
+            std::uint64_t anyValid = 0;
+            for (int word = 0; word < wordCount; ++word)
+            {
+                validSymbols[word] = available[word] & availableInRow[word];
+                anyValid |= validSymbols[word];
+            }
+            if (anyValid)
+            {
+                int selectedSymbol = selectRandomSetBit(validSymbols.data(), wordCount);
+                clearBit(available, selectedSymbol);
+                clearBit(availableInRow.data(), selectedSymbol);
+                addSymbolPosition(selectedSymbol, currentColumn);
+                row.push_back(selectedSymbol);
+                ++currentColumn;
+            }
+            else
+            {
+                auto replacementGraph = constructReplacementGraph(initialAvailable);
+                int selectedElement = selectRandomSetBit(available, wordCount);
+                makeElementAvailable(selectedElement, replacementGraph, row, availableInRow);
+            }
+        }
+        for (int column = 0; column < order; ++column)
+        {
+            int symbol = row[column];
+            cayleyTable->set(rowIndex, column, symbol);
+            firstColumnOfSymbol[symbol] = secondColumnOfSymbol[symbol] = -1;
+        }
+    }
+
+    // Граф замен текущей строки: маски доступных символов столбцов на начало строки без начального элемента.
+    // Хранится как ссылка на снимок initialAvailable и исключенный символ, поэтому не копируется при каждой замене.
+    struct ReplacementGraph
+    {
+        const std::uint64_t *initialAvailable; // Снимок масок столбцов на начало строки.
+        int excludedSymbol;                    // Начальный элемент, исключенный из всех столбцов, или -1.
+    };
+
+    // Строит граф замен для текущей строки.
+    // Параметр initialAvailable: Начальные доступные символы для столбцов.
+    // Возвращает: Граф замен, где для каждого столбца задана маска доступных символов.
+    ReplacementGraph constructReplacementGraph(const ScratchVector<std::uint64_t> &initialAvailable) const
+    {
+        return ReplacementGraph{initialAvailable.data(), -1};
+    }
+
+    // Делает элемент доступным в текущем столбце, обновляя строку и граф замен.
+    // Параметры:
+    //   oldElement: Элемент, который нужно сделать доступным.
+    //   graph: Граф замен для текущей строки.
+    //   row: Текущая строка.
+    //   availableInRow: Маска доступных символов для строки.
+    void makeElementAvailable(int oldElement, ReplacementGraph &graph, ScratchVector<int> &row,
+                              ScratchVector<std::uint64_t> &availableInRow)
+    {
+        ScratchArena::Scope repairScope(getThreadScratchArena());
+        int initialElement = oldElement;
+        eraseInitialElementFromGraph(graph, initialElement);
+        int rowSize = static_cast<int>(row.size());
+        int oldIndex = findSymbol(oldElement, rowSize);
+        int newIndex;
+        ScratchVector<std::uint64_t> visitedPath(wordCount, 0, getThreadScratchArena());
+        ScratchVector<std::uint64_t> choices(wordCount, 0, getThreadScratchArena());
+        ScratchVector<std::uint64_t> availableChoices(wordCount, 0, getThreadScratchArena());
+        for (unsigned long long chainLength = 1;; ++chainLength)
+        {
+            const std::uint64_t *initialChoices = graph.initialAvailable + static_cast<std::size_t>(oldIndex) * wordCount;
+            std::uint64_t anyChoice = 0;
+            for (int word = 0; word < wordCount; ++word)
+            {
+                choices[word] = initialChoices[word];
+                availableChoices[word] = choices[word] & ~visitedPath[word];
+            }
+            if (graph.excludedSymbol >= 0)
+            {
+                clearBit(choices.data(), graph.excludedSymbol);
+                clearBit(availableChoices.data(), graph.excludedSymbol);
+            }
+            for (int word = 0; word < wordCount; ++word)
+            {
+                anyChoice |= availableChoices[word];
+            }
+            if (!anyChoice)
+            {
+                std::fill(visitedPath.begin(), visitedPath.end(), 0);
+                availableChoices = choices;
+            }
+            int newElement = selectRandomSetBit(availableChoices.data(), wordCount);
+            newIndex = findSymbol(newElement, rowSize);
+            placeSymbol(row, oldIndex, newElement);
+            setBit(visitedPath.data(), newElement);
+            if (findSymbol(oldElement, rowSize) == rowSize)
+            {
+                setBit(availableInRow.data(), oldElement);
+            }
+            clearBit(availableInRow.data(), newElement);
+            setBit(columnBits(availableInColumns, oldIndex), oldElement);
+            clearBit(columnBits(availableInColumns, oldIndex), newElement);
+            if (newIndex >= rowSize)
+            {
+                QUASIGROUP_RECORD_REPLACEMENT_CHAIN(chainLength);
+                break;
+            }
+            oldIndex = newIndex;
+            oldElement = newElement;
+        }
+    }
+
+    // Удаляет начальный элемент из графа замен, чтобы избежать его повторного использования.
+    // Параметры:
+    //   graph: Граф замен.
+    //   initialElement: Элемент для удаления.
+    static void eraseInitialElementFromGraph(ReplacementGraph &graph, int initialElement)
+    {
+        graph.excludedSymbol = initialElement;
+    }
+};
+
+// Записывает таблицу Кэли, построенную методом последовательного графа замен, в буфер вызывающего кода.
+// Параметры:
+//   order: Размер квазигруппы.
+//   cayleyTable: Таблица для результата (см. CayleyTable::assignOrder).
+void generateSequentialReplacementGraphCayleyTable(int order, CayleyTable &cayleyTable)
+{
+    SequentialReplacementGraphGenerator::generate(order, cayleyTable);
+}
+
+// Создает таблицу Кэли с помощью метода последовательного графа замен.
+// Параметр order: Размер квазигруппы.
+// Возвращает: Плоскую таблицу Кэли.
+CayleyTable generateSequentialReplacementGraphCayleyTable(int order)
+{
+    CayleyTable cayleyTable;
+    generateSequentialReplacementGraphCayleyTable(order, cayleyTable);
+    return cayleyTable;
+}
+
+// Генератор равномерно распределенных латинских квадратов цепью Маркова Якобсона — Мэтьюза.
+// Квадрат порядка n — это куб инцидентности f(x, y, z) в {0, 1}, где на каждой прямой (фиксированы две
+// координаты) ровно одна единица. Ход ±1 выбирает ячейку (x, y, z) с f = 0 и меняет на ±1 восемь вершин
+// параллелепипеда с противоположной вершиной (x', y', z'). Если f(x', y', z') была 0, получается
+// несобственный куб: в ней -1, а на трех прямых через нее по две единицы; следующий ход начинается из нее
+// и случайно выбирает одну из двух единиц на каждой из трех прямых. Стационарное распределение цепи
+// на собственных кубах равномерно.
+// Каждая прямая хранит свою единицу в плоском массиве n x n (три массива для прямых (строка, столбец),
+// (строка, символ) и (столбец, символ)); вторая единица прямой лежит в списке переполнения, где
+// одновременно не больше нескольких записей. Поэтому ход выполняется за O(1) без выделения памяти,
+// а массив прямых (строка, столбец) собственного куба — это сама таблица Кэли.
+class JacobsonMatthewsSampler
+{
+    struct OverflowEntry
+    {
+        int kind;           // Тип прямой: 0 — (строка, столбец), 1 — (строка, символ), 2 — (столбец, символ).
+        std::size_t line;   // Номер прямой a * n + b.
+        std::uint16_t value; // Третья координата второй единицы.
+    };
+
+    static constexpr std::uint16_t emptyLine = 0xFFFF; // Прямая без единицы (только посреди хода).
+    static constexpr int overflowCapacity = 8;
+
+    int order;                                // Порядок квадрата.
+    std::vector<std::uint16_t> lines[3];      // Единица каждой прямой по типам (см. OverflowEntry::kind).
+    OverflowEntry overflow[overflowCapacity]; // Вторые единицы прямых.
+    int overflowCount = 0;
+    bool isImproper = false;                  // Есть ячейка с f = -1.
+    int improperRow = 0, improperColumn = 0, improperSymbol = 0;
+
+public:
+    static constexpr int maximumOrder = 0xFFFE;
+
+    // Начинает цепь из заданного латинского квадрата.
+    // Параметр initialTable: Латинский квадрат порядка не больше maximumOrder.
+    // Выбрасывает: std::invalid_argument при слишком большом порядке.
+    explicit JacobsonMatthewsSampler(CayleyTableView initialTable) : order(initialTable.getOrder())
+    {
+        if (order > maximumOrder)
+        {
+            throw std::invalid_argument("Цепь Якобсона — Мэтьюза поддерживает порядок не больше 65534");
+        }
+        std::size_t lineCount = static_cast<std::size_t>(order) * order;
+        for (auto &kindLines : lines)
+        {
+            kindLines.assign(lineCount, emptyLine);
+        }
+        for (int row = 0; row < order; ++row)
+        {
+            for (int column = 0; column < order; ++column)
+            {
+                addCell(row, column, initialTable(row, column));
+            }
+        }
+    }
+
+    int getOrder() const { return order; }
+    bool isProper() const { return !isImproper; }
+
+    // Переходит на stepCount собственных квадратов вперед; шаг — это один ход из собственного куба
+    // и ходы из несобственных до возврата в собственный.
+    // Считать нужно именно собственные квадраты: последовательность посещенных собственных кубов — цепь
+    // Маркова с равномерным стационарным распределением, а первый собственный куб после фиксированного
+    // числа ходов смещен к квадратам, в которые цепь приходит после долгих несобственных участков.
+    // Параметр stepCount: Число шагов.
+    void advance(long long stepCount)
+    {
+        for (long long step = 0; step < stepCount; ++step)
+        {
+            do
+            {
+                makeMove();
+            } while (isImproper);
+        }
+    }
+
+    // Выполняет один ход ±1.
+    void makeMove()
+    {
+        if (order < 2)
+        {
+            return;
+        }
+        std::mt19937 &generator = getRandomNumberGenerator();
+        int row, column, symbol, otherRow, otherColumn, otherSymbol;
+        if (!isImproper)
+        {
+            std::uniform_int_distribution<int> element(0, order - 1);
+            row = element(generator);
+            column = element(generator);
+            int currentSymbol = lines[0][lineIndex(row, column)];
+            symbol = std::uniform_int_distribution<int>(0, order - 2)(generator);
+            symbol += symbol >= currentSymbol;
+            otherRow = lines[2][lineIndex(column, symbol)];
+            otherColumn = lines[1][lineIndex(row, symbol)];
+            otherSymbol = currentSymbol;
+        }
+        else
+        {
+            row = improperRow;
+            column = improperColumn;
+            symbol = improperSymbol;
+            // Три независимых выбора из двух берутся из битов одного случайного числа.
+            std::uint32_t choices = generator();
+            otherRow = pickOneOfTwo(2, lineIndex(column, symbol), choices & 1U);
+            otherColumn = pickOneOfTwo(1, lineIndex(row, symbol), choices & 2U);
+            otherSymbol = pickOneOfTwo(0, lineIndex(row, column), choices & 4U);
+        }
+        // Сначала +1 в (x, y, z) (снимает прежнюю -1), затем все -1, затем остальные +1: так в каждый момент
+        // не больше одной ячейки с -1, а на прямой не больше двух единиц.
+        addCell(row, column, symbol);
+        removeCell(row, column, otherSymbol);
+        removeCell(row, otherColumn, symbol);
+        removeCell(otherRow, column, symbol);
+        removeCell(otherRow, otherColumn, otherSymbol);
+        addCell(row, otherColumn, otherSymbol);
+        addCell(otherRow, column, otherSymbol);
+        addCell(otherRow, otherColumn, symbol);
+    }
+
+    // Копирует текущий квадрат в таблицу (см. CayleyTable::assignOrder).
+    // Параметр table: Таблица для результата.
+    // Выбрасывает: std::logic_error, если куб несобственный (сначала нужен advance).
+    void copyTo(CayleyTable &table) const
+    {
+        if (isImproper)
+        {
+            throw std::logic_error("Куб несобственный: квадрат еще не получен");
+        }
+        table.assignOrder(order);
+        table.visitMutableCells([&](auto cells)
+                                { std::copy(lines[0].begin(), lines[0].end(), cells.cells); });
+    }
+
+private:
+    std::size_t lineIndex(int first, int second) const { return static_cast<std::size_t>(first) * order + second; }
+
+    // Выбирает одну из двух единиц прямой несобственного куба по случайному биту.
+    int pickOneOfTwo(int kind, std::size_t line, bool takePrimary) const
+    {
+        if (takePrimary)
+        {
+            return lines[kind][line];
+        }
+        for (int entry = 0; entry < overflowCount; ++entry)
+        {
+            if (overflow[entry].kind == kind && overflow[entry].line == line)
+            {
+                return overflow[entry].value;
+            }
+        }
+        return lines[kind][line];
+    }
+
+    void insertValue(int kind, std::size_t line, int value)
+    {
+        if (lines[kind][line] == emptyLine)
+        {
+            lines[kind][line] = static_cast<std::uint16_t>(value);
+        }
+        else
+        {
+            overflow[overflowCount++] = {kind, line, static_cast<std::uint16_t>(value)};
+        }
+    }
+
+    void eraseValue(int kind, std::size_t line, int value)
+    {
+        int found = -1;
+        for (int entry = 0; entry < overflowCount; ++entry)
+        {
+            if (overflow[entry].kind == kind && overflow[entry].line == line)
+            {
+                found = entry;
+                break;
+            }
+        }
+        if (lines[kind][line] == value)
+        {
+            lines[kind][line] = found < 0 ? emptyLine : overflow[found].value;
+        }
+        if (found >= 0)
+        {
+            overflow[found] = overflow[--overflowCount];
+        }
+    }
+
+    // f(x, y, z) += 1.
+    void addCell(int row, int column, int symbol)
+    {
+        if (isImproper && row == improperRow && column == improperColumn && symbol == improperSymbol)
+        {
+            isImproper = false;
+            return;
+        }
+        insertValue(0, lineIndex(row, column), symbol);
+        insertValue(1, lineIndex(row, symbol), column);
+        insertValue(2, lineIndex(column, symbol), row);
+    }
+
+    // f(x, y, z) -= 1: единица снимается, а из нуля получается -1.
+    void removeCell(int row, int column, int symbol)
+    {
+        std::size_t line = lineIndex(row, column);
+        bool isPresent = lines[0][line] == symbol;
+        for (int entry = 0; entry < overflowCount && !isPresent; ++entry)
+        {
+            isPresent = overflow[entry].kind == 0 && overflow[entry].line == line && overflow[entry].value == symbol;
+        }
+        if (!isPresent)
+        {
+            isImproper = true;
+            improperRow = row;
+            improperColumn = column;
+            improperSymbol = symbol;
+            return;
+        }
+        eraseValue(0, line, symbol);
+        eraseValue(1, lineIndex(row, symbol), column);
+        eraseValue(2, lineIndex(column, symbol), row);
+    }
+};
+
+// Выводит таблицу Кэли в консоль в читаемом формате.
+// Параметр table: Таблица Кэли для вывода.
+// Форматирует таблицу с заголовками строк и столбцов.
+void printCayleyTable(CayleyTableView table)
+{
+    int order = table.getOrder();
+    std::cout << "\n  | ";
+    for (int column = 0; column < order; ++column)
+    {
+        std::cout << column << ' ';
+    }
+    std::cout << "\n--+-";
+    for (int column = 0; column < order; ++column)
+    {
+        std::cout << "--";
+    }
+    std::cout << "\n";
+    for (int row = 0; row < order; ++row)
+    {
+        std::cout << row << " | ";
+        for (int column = 0; column < order; ++column)
+        {
+            std::cout << table(row, column) << ' ';
+        }
+        std::cout << "\n";
+    }
+}
+
+// Выводит множество элементов в виде {a b c}.
+// Параметры:
+//   stream: Поток вывода.
+//   elements: Элементы множества.
+void printElementSet(std::ostream &stream, const std::vector<int> &elements)
+{
+    stream << '{';
+    for (std::size_t index = 0; index < elements.size(); ++index)
+    {
+        stream << (index ? " " : "") << elements[index];
+    }
+    stream << '}';
+}
+
+// Выводит решётку подквазигрупп в консоль.
+// Параметр lattice: Решётка, построенная Quasigroup::enumerateSubquasigroupLattice.
+// Для каждого узла печатает размер, порождающее множество, элементы и непосредственно вложенные узлы.
+void printSubquasigroupLattice(const SubquasigroupLattice &lattice)
+{
+    auto printList = [](const std::vector<int> &values) { printElementSet(std::cout, values); };
+    std::cout << "Подквазигрупп, порожденных одним или двумя элементами: " << lattice.nodes.size() << "\n";
+    for (std::size_t index = 0; index < lattice.nodes.size(); ++index)
+    {
+        const auto &node = lattice.nodes[index];
+        std::cout << '#' << index << ": размер " << node.elements.size() << ", порождающие ";
+        printList(node.generators);
+        std::cout << ", элементы ";
+        printList(node.elements);
+        std::cout << ", содержит ";
+        printList(node.maximalSubnodes);
+        std::cout << "\n";
+    }
+}
+
+// Записывает таблицу Кэли в текстовом формате readCayleyTableFromFile: порядок, затем строки таблицы.
+// Параметры:
+//   stream: Поток вывода.
+//   table: Таблица Кэли.
+void writeCayleyTableText(std::ostream &stream, CayleyTableView table)
+{
+    int order = table.getOrder();
+    stream << order << "\n";
+    for (int row = 0; row < order; ++row)
+    {
+        for (int column = 0; column < order; ++column)
+        {
+            stream << table(row, column) << ' ';
+        }
+        stream << "\n";
+    }
+}
+
+// Записывает таблицу Кэли в двоичном формате (см. binaryCayleyTableMagic).
+// Параметры:
+//   table: Таблица Кэли.
+//   fileName: Имя файла для записи.
+// Выбрасывает: std::runtime_error, если файл не удалось открыть или записать.
+void writeBinaryCayleyTableToFile(CayleyTableView table, const std::string &fileName)
+{
+    if (!isLittleEndianHost())
+    {
+        throw std::runtime_error("Двоичные таблицы Кэли поддерживаются только на little-endian платформах");
+    }
+    unsigned char header[binaryCayleyTableHeaderSize] = {};
+    auto writeUnsigned = [&](std::size_t offset, std::uint64_t value, int byteCount)
+    { storeLittleEndian(header + offset, value, byteCount); };
+    std::memcpy(header, binaryCayleyTableMagic, sizeof(binaryCayleyTableMagic));
+    writeUnsigned(8, binaryCayleyTableVersion, 4);
+    writeUnsigned(12, static_cast<std::uint64_t>(table.getCellWidth()), 4);
+    writeUnsigned(16, static_cast<std::uint64_t>(table.getOrder()), 4);
+    writeUnsigned(24, computeFnv1a64(table.data(), table.getByteSize()), 8);
+    std::ofstream file(fileName, std::ios::binary);
+    if (!file)
+    {
+        throw std::runtime_error("Не удалось открыть файл для записи");
+    }
+    file.write(reinterpret_cast<const char *>(header), sizeof(header));
+    file.write(static_cast<const char *>(table.data()), static_cast<std::streamsize>(table.getByteSize()));
+    if (!file)
+    {
+        throw std::runtime_error("Не удалось записать двоичную таблицу Кэли");
+    }
+}
+
+// Сохраняет только таблицу Кэли: в двоичном формате для расширения .qgb, иначе в текстовом.
+// Параметры:
+//   table: Таблица Кэли.
+//   fileName: Имя файла для записи.
+// Выбрасывает: std::runtime_error, если файл не удалось открыть или записать.
+void writeCayleyTableToFile(CayleyTableView table, const std::string &fileName)
+{
+    if (hasBinaryCayleyTableExtension(fileName))
+    {
+        writeBinaryCayleyTableToFile(table, fileName);
+        return;
+    }
+    std::ofstream file(fileName);
+    if (!file)
+    {
+        throw std::runtime_error("Не удалось открыть файл для записи");
+    }
+    writeCayleyTableText(file, table);
+    if (!file)
+    {
+        throw std::runtime_error("Не удалось записать таблицу Кэли");
+    }
+}
+
+// Корпус таблиц Кэли (.qgc) — файл, в который таблицы только дописываются. Все поля little-endian:
+//   заголовок файла (16 байт): магическое число "QGCORPUS" (8 байт), версия (uint32, сейчас 1), 0 (uint32);
+//   затем записи подряд, у каждой заголовок (16 байт): порядок (uint32), ширина ячейки (uint32),
+//   FNV-1a (uint64) ячеек, — и ячейки построчно, как в формате .qgb.
+// Записи не дополняются до 8 байт: после таблицы, у которой n^2 * ширина не кратно 8, следующие заголовки и
+// ячейки не выровнены. Читатели копируют записи в буфер таблицы, поэтому выравнивание в файле не нужно.
+// Порядок записей задает номер таблицы.
+constexpr char cayleyTableCorpusMagic[8] = {'Q', 'G', 'C', 'O', 'R', 'P', 'U', 'S'};
+constexpr std::uint32_t cayleyTableCorpusVersion = 1;
+constexpr std::size_t cayleyTableCorpusHeaderSize = 16;
+constexpr std::size_t cayleyTableCorpusRecordHeaderSize = 16;
+
+// Дописывает таблицы в корпус. Новый файл получает заголовок; у существующего заголовок проверяется.
+class CayleyTableCorpusWriter
+{
+    std::ofstream file; // Файл корпуса, открытый на дозапись.
+
+public:
+    // Открывает корпус на дозапись.
+    // Параметр fileName: Путь к файлу корпуса; создается, если его нет.
+    // Выбрасывает: std::runtime_error, если файл не удалось открыть или он не является корпусом.
+    explicit CayleyTableCorpusWriter(const std::string &fileName)
+    {
+        if (!isLittleEndianHost())
+        {
+            throw std::runtime_error("Корпуса таблиц Кэли поддерживаются только на little-endian платформах");
+        }
+        std::ifstream existing(fileName, std::ios::binary);
+        unsigned char header[cayleyTableCorpusHeaderSize] = {};
+        bool isEmpty = !existing || existing.peek() == std::ifstream::traits_type::eof();
+        if (!isEmpty)
+        {
+            if (!existing.read(reinterpret_cast<char *>(header), sizeof(header)) ||
+                std::memcmp(header, cayleyTableCorpusMagic, sizeof(cayleyTableCorpusMagic)) != 0 ||
+                loadLittleEndian(header + 8, 4) != cayleyTableCorpusVersion)
+            {
+                throw std::runtime_error("Файл не является корпусом таблиц Кэли поддерживаемой версии");
+            }
+        }
+        existing.close();
+        file.open(fileName, std::ios::binary | std::ios::app);
+        if (!file)
+        {
+            throw std::runtime_error("Не удалось открыть файл для записи");
+        }
+        if (isEmpty)
+        {
+            std::memcpy(header, cayleyTableCorpusMagic, sizeof(cayleyTableCorpusMagic));
+            storeLittleEndian(header + 8, cayleyTableCorpusVersion, 4);
+            file.write(reinterpret_cast<const char *>(header), sizeof(header));
+        }
+    }
+
+    // Дописывает таблицу в конец корпуса.
+    // Параметр table: Таблица Кэли.
+    // Выбрасывает: std::runtime_error при ошибке записи.
+    void append(CayleyTableView table)
+    {
+        unsigned char header[cayleyTableCorpusRecordHeaderSize] = {};
+        storeLittleEndian(header, static_cast<std::uint64_t>(table.getOrder()), 4);
+        storeLittleEndian(header + 4, static_cast<std::uint64_t>(table.getCellWidth()), 4);
+        storeLittleEndian(header + 8, computeFnv1a64(table.data(), table.getByteSize()), 8);
+        file.write(reinterpret_cast<const char *>(header), sizeof(header));
+        file.write(static_cast<const char *>(table.data()), static_cast<std::streamsize>(table.getByteSize()));
+        if (!file)
+        {
+            throw std::runtime_error("Не удалось записать таблицу в корпус");
+        }
+    }
+};
+
+// Последовательно читает таблицы корпуса, не загружая его целиком: память занимает одна таблица.
+class CayleyTableCorpusReader
+{
+    std::ifstream file; // Файл корпуса.
+
+public:
+    // Открывает корпус и проверяет его заголовок.
+    // Параметр fileName: Путь к файлу корпуса.
+    // Выбрасывает: std::runtime_error, если файл не удалось открыть или он не является корпусом.
+    explicit CayleyTableCorpusReader(const std::string &fileName) : file(fileName, std::ios::binary)
+    {
+        if (!file)
+        {
+            throw std::runtime_error("Не удалось открыть файл");
+        }
+        if (!isLittleEndianHost())
+        {
+            throw std::runtime_error("Корпуса таблиц Кэли поддерживаются только на little-endian платформах");
+        }
+        unsigned char header[cayleyTableCorpusHeaderSize] = {};
+        if (!file.read(reinterpret_cast<char *>(header), sizeof(header)) ||
+            std::memcmp(header, cayleyTableCorpusMagic, sizeof(cayleyTableCorpusMagic)) != 0 ||
+            loadLittleEndian(header + 8, 4) != cayleyTableCorpusVersion)
+        {
+            throw std::runtime_error("Файл не является корпусом таблиц Кэли поддерживаемой версии");
+        }
+    }
+
+    // Читает следующую таблицу. Если порядок совпадает с порядком table, ее буфер используется повторно.
+    // Параметр table: Таблица, в которую читается запись.
+    // Возвращает: false, если корпус закончился.
+    // Выбрасывает: std::runtime_error при обрезанной или поврежденной записи.
+    bool readNext(CayleyTable &table)
+    {
+        unsigned char header[cayleyTableCorpusRecordHeaderSize] = {};
+        file.read(reinterpret_cast<char *>(header), sizeof(header));
+        if (file.gcount() == 0 && file.eof())
+        {
+            return false;
+        }
+        if (!file)
+        {
+            throw std::runtime_error("Обрезанная запись корпуса таблиц Кэли");
+        }
+        std::uint64_t order = loadLittleEndian(header, 4);
+        if (order == 0 || order > static_cast<std::uint64_t>(std::numeric_limits<int>::max()) ||
+            loadLittleEndian(header + 4, 4) !=
+                static_cast<std::uint64_t>(CayleyTable::selectCellWidth(static_cast<int>(order))))
+        {
+            throw std::runtime_error("Некорректный заголовок записи корпуса таблиц Кэли");
+        }
+        if (table.getOrder() != static_cast<int>(order) || !table.data())
+        {
+            table = CayleyTable(static_cast<int>(order));
+        }
+        if (!file.read(static_cast<char *>(table.data()), static_cast<std::streamsize>(table.getByteSize())))
+        {
+            throw std::runtime_error("Обрезанная запись корпуса таблиц Кэли");
+        }
+        verifyBinaryCayleyTable(table, loadLittleEndian(header + 8, 8));
+        return true;
+    }
+};
+
+// Читает корпус в фоновом потоке на prefetchDepth таблиц вперед, чтобы чтение шло одновременно с анализом.
+// Буферы таблиц переходят между потоком чтения и вызывающим по кругу, поэтому память постоянна:
+// prefetchDepth + 1 таблица независимо от размера корпуса.
+class PrefetchingCayleyTableCorpusReader
+{
+    CayleyTableCorpusReader reader;      // Последовательное чтение корпуса (только в фоновом потоке).
+    std::mutex mutex;                    // Защищает очереди и флаги ниже.
+    std::condition_variable changed;     // Сигнал об изменении очередей или флагов.
+    std::vector<CayleyTable> freeTables; // Буферы, которые поток чтения может заполнить.
+    std::deque<CayleyTable> readyTables; // Прочитанные таблицы по порядку.
+    bool isFinished = false;             // Поток чтения дошел до конца корпуса или ошибки.
+    bool isStopping = false;             // Деструктор просит поток чтения завершиться.
+    std::exception_ptr readError;        // Исключение потока чтения для передачи вызывающему.
+    std::thread readerThread;            // Поток чтения.
+
+    void readAll()
+    {
+        while (true)
+        {
+            CayleyTable table;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&] { return isStopping || !freeTables.empty(); });
+                if (isStopping)
+                {
+                    break;
+                }
+                table = std::move(freeTables.back());
+                freeTables.pop_back();
+            }
+            bool hasTable = false;
+            std::exception_ptr error;
+            try
+            {
+                hasTable = reader.readNext(table);
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!hasTable)
+            {
+                readError = error;
+                isFinished = true;
+                changed.notify_all();
+                return;
+            }
+            readyTables.push_back(std::move(table));
+            changed.notify_all();
+        }
+    }
+
+public:
+    // Открывает корпус и запускает поток чтения.
+    // Параметры:
+    //   fileName: Путь к файлу корпуса.
+    //   prefetchDepth: Сколько таблиц читать заранее (не меньше 1).
+    // Выбрасывает: std::runtime_error, если файл не удалось открыть или он не является корпусом.
+    explicit PrefetchingCayleyTableCorpusReader(const std::string &fileName, std::size_t prefetchDepth = 2)
+        : reader(fileName), freeTables(std::max<std::size_t>(prefetchDepth, 1))
+    {
+        readerThread = std::thread([this] { readAll(); });
+    }
+
+    PrefetchingCayleyTableCorpusReader(const PrefetchingCayleyTableCorpusReader &) = delete;
+    PrefetchingCayleyTableCorpusReader &operator=(const PrefetchingCayleyTableCorpusReader &) = delete;
+
+    ~PrefetchingCayleyTableCorpusReader()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            isStopping = true;
+        }
+        changed.notify_all();
+        readerThread.join();
+    }
+
+    // Отдает следующую прочитанную таблицу, забирая прежний буфер table для повторного использования.
+    // Параметр table: Принимает следующую таблицу; ее прежнее содержимое возвращается потоку чтения.
+    // Возвращает: false, если корпус закончился.
+    // Выбрасывает: std::runtime_error, если поток чтения встретил поврежденную запись.
+    bool readNext(CayleyTable &table)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&] { return !readyTables.empty() || isFinished; });
+        if (readyTables.empty())
+        {
+            if (readError)
+            {
+                std::rethrow_exception(readError);
+            }
+            return false;
+        }
+        std::swap(table, readyTables.front());
+        freeTables.push_back(std::move(readyTables.front()));
+        readyTables.pop_front();
+        changed.notify_all();
+        return true;
+    }
+};
+
+// Файл результатов проверки (.qgr) — компактные записи вместо текстовых строк. Все поля little-endian:
+//   заголовок файла (16 байт): магическое число "QGRESULT" (8 байт), версия (uint32, сейчас 1), 0 (uint32);
+//   затем записи подряд, у каждой заголовок (40 байт): номер таблицы (uint64), FNV-1a ячеек (uint64, 0 без
+//   таблицы — для --formula), порядок (uint32), размер свидетеля (uint32, 0 — свидетеля нет), alpha, beta, c
+//   (uint32 каждый, 0xFFFFFFFF — параметр не задан), флаги (uint32: бит 0 — собственные проверялись, бит 1 —
+//   найдены, бит 2 — нетривиальные проверялись, бит 3 — найдены), — и при ненулевом размере свидетеля его
+//   битовое множество: ceil(n / 64) слов uint64, элемент x — бит x % 64 слова x / 64.
+// Свидетель — меньшее из множеств properWitness и nonTrivialWitness анализа. Записи кратны 8 байтам;
+// файлы шардов дописываются друг к другу без заголовков.
+constexpr char batchResultMagic[8] = {'Q', 'G', 'R', 'E', 'S', 'U', 'L', 'T'};
+constexpr std::uint32_t batchResultVersion = 1;
+constexpr std::size_t batchResultHeaderSize = 16;
+constexpr std::size_t batchResultRecordHeaderSize = 40;
+
+// Проверяет, задает ли путь файл результатов .qgr.
+bool hasBatchResultExtension(const std::string &fileName)
+{
+    const std::string extension = ".qgr";
+    return fileName.size() >= extension.size() &&
+           fileName.compare(fileName.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+// Результат проверки одной таблицы для записи .qgr.
+struct BatchResultRecord
+{
+    std::uint64_t tableId = 0;           // Номер таблицы в запуске.
+    std::uint64_t tableHash = 0;         // FNV-1a ячеек; 0 без таблицы.
+    int order = 0;                       // Порядок квазигруппы.
+    int coefficientAlpha = -1;           // Параметры аффинной квазигруппы; -1 — не заданы.
+    int coefficientBeta = -1;
+    int constantC = -1;
+    bool checksProper = false;           // Проверялись собственные подквазигруппы.
+    bool hasProperSubquasigroups = false;
+    bool checksNonTrivial = false;       // Проверялись нетривиальные подквазигруппы.
+    bool hasNonTrivialSubquasigroups = false;
+    const SubquasigroupAnalysis *witnesses = nullptr; // Свидетели найденных вердиктов; nullptr — не собирались.
+};
+
+// Записывает результаты .qgr через буфер: записи копируются в память и сбрасываются в файл блоками по 1 МиБ,
+// поэтому миллион записей — это несколько десятков МиБ и порядка сотни системных вызовов write.
+class BatchResultWriter
+{
+    static constexpr std::size_t flushThreshold = std::size_t(1) << 20;
+    std::ofstream file;                 // Файл результатов.
+    std::vector<unsigned char> buffer;  // Еще не записанные записи.
+
+public:
+    // Создает файл результатов и записывает заголовок.
+    // Параметр fileName: Путь к файлу; существующий файл перезаписывается.
+    // Выбрасывает: std::runtime_error, если файл не удалось открыть.
+    explicit BatchResultWriter(const std::string &fileName)
+    {
+        if (!isLittleEndianHost())
+        {
+            throw std::runtime_error("Файлы результатов .qgr поддерживаются только на little-endian платформах");
+        }
+        file.open(fileName, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            throw std::runtime_error("Не удалось открыть файл для записи");
+        }
+        buffer.reserve(flushThreshold + batchResultRecordHeaderSize);
+        buffer.resize(batchResultHeaderSize);
+        std::memcpy(buffer.data(), batchResultMagic, sizeof(batchResultMagic));
+        storeLittleEndian(buffer.data() + 8, batchResultVersion, 4);
+    }
+
+    BatchResultWriter(const BatchResultWriter &) = delete;
+    BatchResultWriter &operator=(const BatchResultWriter &) = delete;
+
+    // Записывает остаток буфера; ошибки записи здесь не сообщаются — для них есть flush.
+    ~BatchResultWriter()
+    {
+        if (!buffer.empty())
+        {
+            file.write(reinterpret_cast<const char *>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+        }
+    }
+
+    // Добавляет запись в буфер и при его заполнении сбрасывает буфер в файл.
+    // Параметр record: Результат проверки таблицы.
+    // Выбрасывает: std::runtime_error при ошибке записи.
+    void append(const BatchResultRecord &record)
+    {
+        const std::vector<int> *witness = nullptr;
+        if (record.witnesses)
+        {
+            if (record.hasProperSubquasigroups && !record.witnesses->properWitness.empty())
+            {
+                witness = &record.witnesses->properWitness;
+            }
+            if (record.hasNonTrivialSubquasigroups && !record.witnesses->nonTrivialWitness.empty() &&
+                (!witness || record.witnesses->nonTrivialWitness.size() < witness->size()))
+            {
+                witness = &record.witnesses->nonTrivialWitness;
+            }
+        }
+        std::size_t wordCount = witness ? (static_cast<std::size_t>(record.order) + 63) / 64 : 0;
+        std::size_t offset = buffer.size();
+        buffer.resize(offset + batchResultRecordHeaderSize + 8 * wordCount, 0);
+        unsigned char *bytes = buffer.data() + offset;
+        auto parameter = [](int value) { return value < 0 ? 0xFFFFFFFFull : static_cast<std::uint64_t>(value); };
+        storeLittleEndian(bytes, record.tableId, 8);
+        storeLittleEndian(bytes + 8, record.tableHash, 8);
+        storeLittleEndian(bytes + 16, static_cast<std::uint64_t>(record.order), 4);
+        storeLittleEndian(bytes + 20, witness ? witness->size() : 0, 4);
+        storeLittleEndian(bytes + 24, parameter(record.coefficientAlpha), 4);
+        storeLittleEndian(bytes + 28, parameter(record.coefficientBeta), 4);
+        storeLittleEndian(bytes + 32, parameter(record.constantC), 4);
+        storeLittleEndian(bytes + 36, (record.checksProper ? 1u : 0u) | (record.hasProperSubquasigroups ? 2u : 0u) |
+                                          (record.checksNonTrivial ? 4u : 0u) |
+                                          (record.hasNonTrivialSubquasigroups ? 8u : 0u), 4);
+        if (witness)
+        {
+            unsigned char *bitset = bytes + batchResultRecordHeaderSize;
+            for (int element : *witness)
+            {
+                bitset[element / 8] |= static_cast<unsigned char>(1u << (element % 8));
+            }
+        }
+        if (buffer.size() >= flushThreshold)
+        {
+            flush();
+        }
+    }
+
+    // Сбрасывает буфер в файл.
+    // Выбрасывает: std::runtime_error при ошибке записи.
+    void flush()
+    {
+        file.write(reinterpret_cast<const char *>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+        if (!file.flush())
+        {
+            throw std::runtime_error("Не удалось записать файл результатов");
+        }
+    }
+};
+
+// Сохраняет таблицу Кэли и результаты проверки подквазигрупп в файл.
+// Параметры:
+//   quasigroup: Квазигруппа; таблица берется из нее же, без второй ссылки на исходную.
+//   fileName: Имя файла для записи; для .qgr — одна компактная запись BatchResultWriter без таблицы.
+// Записывает порядок, таблицу и результаты проверки; результаты берутся из кэша квазигруппы.
+void writeResultsToFile(const Quasigroup &quasigroup, const std::string &fileName)
+{
+    if (hasBatchResultExtension(fileName))
+    {
+        CayleyTableView table = quasigroup.getCayleyTable();
+        BatchResultRecord record;
+        record.tableHash = computeFnv1a64(table.data(), table.getByteSize());
+        record.order = table.getOrder();
+        const SubquasigroupAnalysis &analysis = quasigroup.analyzeSubquasigroups();
+        record.checksProper = record.checksNonTrivial = true;
+        record.hasProperSubquasigroups = analysis.hasProperSubquasigroups;
+        record.hasNonTrivialSubquasigroups = analysis.hasNonTrivialSubquasigroups;
+        record.witnesses = &analysis;
+        BatchResultWriter writer(fileName);
+        writer.append(record);
+        writer.flush();
+        std::cout << "Результаты сохранены в " << fileName << "\n";
+        return;
+    }
+    std::ofstream file(fileName);
+    if (!file)
+    {
+        throw std::runtime_error("Не удалось открыть файл для записи");
+    }
+    writeCayleyTableText(file, quasigroup.getCayleyTable());
+    const SubquasigroupAnalysis &analysis = quasigroup.analyzeSubquasigroups();
+    bool hasProperSubquasigroups = analysis.hasProperSubquasigroups;
+    bool hasNonTrivialSubquasigroups = analysis.hasNonTrivialSubquasigroups;
+    file << "\nРезультаты проверки:\n";
+    file << "- Собственные подквазигруппы: " << (hasProperSubquasigroups ? "присутствуют" : "отсутствуют") << "\n";
+    file << "- Нетривиальные подквазигруппы: " << (hasNonTrivialSubquasigroups ? "присутствуют" : "отсутствуют") << "\n";
+    if (hasProperSubquasigroups && hasNonTrivialSubquasigroups)
+    {
+        file << "Квазигруппа содержит собственные нетривиальные подквазигруппы.\n";
+    }
+    else
+    {
+        file << "Квазигруппа не содержит одновременно собственных и нетривиальных подквазигрупп.\n";
+    }
+    std::cout << "Результаты сохранены в " << fileName << "\n";
+}
+
+// Параметры пакетного режима, заданные в командной строке.
+struct BatchOptions
+{
+    std::string generatorName;         // cyclic, affine, affine-sweep, srg или jm; пусто при inputCorpusName.
+    std::string inputCorpusName;       // Корпус .qgc для проверки вместо генерации.
+    std::string outputCorpusName;      // Корпус .qgc, в который дописываются сгенерированные таблицы.
+    std::string permutationName = "random"; // Перестановка f для affine-sweep: identity или random.
+    int order = 0;                     // Порядок генерируемых таблиц.
+    long long tableCount = 1;          // Число таблиц.
+    std::string checkName = "both";    // proper, nontrivial, both или none.
+    std::string outputFileName;        // Файл построчных результатов; пусто — не записывать.
+    std::optional<std::uint32_t> seed; // Зерно генератора случайных чисел.
+    unsigned threadCount = 1;          // Потоки для параллельной проверки одной таблицы.
+    unsigned jobCount = 1;             // Потоки, генерирующие и проверяющие разные таблицы одновременно.
+    bool useFormula = false;           // Анализ cyclic и affine (f тождественная) по формуле, без таблиц.
+    int fieldCharacteristic = 0;       // p для affine и affine-sweep над GF(p^m); 0 — по модулю n.
+    int fieldDegree = 0;               // m для GF(p^m).
+    long long moveCount = 0;           // Шаги цепи jm между таблицами; 0 — порядок таблицы.
+    std::string countersFileName;      // JSON счетчиков QUASIGROUP_ENABLE_COUNTERS; пусто — не записывать.
+    long long shardCount = 0;          // Число шардов --shards; 0 — запуск без разбиения.
+    std::optional<long long> shardIndex; // Единственный обрабатываемый шард (--shard); пусто — все шарды.
+    std::string shardDirectory = ".";  // Каталог файлов шардов.
+    long long firstWorkUnit = 0;       // Первая единица работы шарда: номер таблицы или пары (alpha, beta).
+    long long endWorkUnit = -1;        // Конец диапазона единиц работы; -1 — до конца.
+};
+
+// Выводит справку по параметрам пакетного режима.
+// Параметр stream: Поток вывода.
+void printBatchUsage(std::ostream &stream)
+{
+    stream << "Пакетный режим:\n"
+           << "  --generate cyclic|affine|srg  Генератор таблиц (srg — последовательный граф замен)\n"
+           << "  --generate jm                 Равномерно случайные латинские квадраты (цепь Якобсона — Мэтьюза)\n"
+           << "  --moves K                     Шаги цепи jm между таблицами (по умолчанию N; прогрев N^2 шагов)\n"
+           << "  --generate affine-sweep       Все (alpha, beta, c) для порядка N; --count не используется\n"
+           << "  --permutation identity|random Перестановка f для affine-sweep (по умолчанию random)\n"
+           << "  --order N                     Порядок квазигрупп\n"
+           << "  --count K                     Число таблиц (по умолчанию 1)\n"
+           << "  --check proper|nontrivial|both|none  Проверки (по умолчанию both)\n"
+           << "  --out FILE                    Файл результатов: index order proper nontrivial [alpha beta c]\n"
+           << "  --out FILE.qgr                Компактные двоичные записи: номер, хеш, порядок, alpha beta c,\n"
+           << "                                флаги, размер и битовое множество свидетеля\n"
+           << "  --seed S                      Зерно генератора случайных чисел\n"
+           << "  --threads T                   Потоки для проверки одной таблицы (по умолчанию 1)\n"
+           << "  --jobs J                      Потоки, генерирующие и проверяющие разные таблицы (по умолчанию 1);\n"
+           << "                                таблица i строится из своего потока случайных чисел (зерно, i),\n"
+           << "                                поэтому результат не зависит от J; с --input таблицы корпуса\n"
+           << "                                проверяются пакетами, по таблице на поток\n"
+           << "  --input FILE.qgc              Проверить таблицы корпуса вместо генерации (--order не нужен)\n"
+           << "  --corpus-out FILE.qgc         Дописать сгенерированные таблицы в корпус\n"
+           << "  --formula                     cyclic/affine/affine-sweep по формуле без таблиц (f тождественная;\n"
+           << "                                для affine-sweep нужен --permutation identity)\n"
+           << "  --field P^M                   affine/affine-sweep над полем GF(P^M) вместо вычетов (порядок P^M)\n"
+           << "  --counters-out FILE.json      Счетчики горячих путей и время фаз (сборка с\n"
+           << "                                -DQUASIGROUP_ENABLE_COUNTERS=1)\n"
+           << "  --shards K                    Разбить номера таблиц (для affine-sweep — пары alpha, beta) на K\n"
+           << "                                шардов (кроме jm); нужен --seed. Готовые шарды при повторном\n"
+           << "                                запуске пропускаются, --out собирается, когда готовы все шарды\n"
+           << "  --shard I                     Выполнить только шард I из [0, K) (один узел или процесс)\n"
+           << "  --shard-dir DIR               Каталог файлов шардов (по умолчанию текущий)\n"
+           << "--convert IN OUT: перезаписывает таблицу IN в OUT (.qgb — двоичный формат, иначе текстовый)\n"
+           << "--encode|--decode TABLE LEADERS IN OUT: e-преобразование файла (порядок таблицы не больше 256)\n"
+           << "Без параметров запускается интерактивное меню.\n";
+}
+
+// Разбирает целочисленное значение параметра командной строки.
+// Параметры:
+//   optionName: Имя параметра для сообщения об ошибке.
+//   text: Значение параметра.
+//   minimumValue: Минимально допустимое значение.
+//   maximumValue: Максимально допустимое значение (по умолчанию — без ограничения сверху); задается, когда
+//                 значение сохраняется в более узкий тип.
+// Возвращает: Разобранное значение.
+// Выбрасывает: std::invalid_argument, если значение не является целым числом из [minimumValue, maximumValue].
+long long parseIntegerOption(const std::string &optionName, const std::string &text, long long minimumValue,
+                             long long maximumValue = std::numeric_limits<long long>::max())
+{
+    std::size_t parsedLength = 0;
+    long long value = 0;
+    try
+    {
+        value = std::stoll(text, &parsedLength);
+    }
+    catch (const std::exception &)
+    {
+        parsedLength = 0;
+    }
+    if (parsedLength == 0 || parsedLength != text.size() || value < minimumValue || value > maximumValue)
+    {
+        throw std::invalid_argument("Некорректное значение " + optionName + ": " + text);
+    }
+    return value;
+}
+
+// Разбирает параметры пакетного режима.
+// Параметры argc, argv: Аргументы main.
+// Возвращает: Заполненные параметры.
+// Выбрасывает: std::invalid_argument при неизвестном или некорректном параметре.
+BatchOptions parseBatchOptions(int argc, char **argv)
+{
+    BatchOptions options;
+    for (int index = 1; index < argc; ++index)
+    {
+        std::string argument = argv[index];
+        auto nextValue = [&]() -> std::string
+        {
+            if (index + 1 >= argc)
+            {
+                throw std::invalid_argument("Не указано значение параметра " + argument);
+            }
+            return argv[++index];
+        };
+        if (argument == "--generate")
+        {
+            options.generatorName = nextValue();
+        }
+        else if (argument == "--order")
+        {
+            options.order = static_cast<int>(
+                parseIntegerOption(argument, nextValue(), 1, std::numeric_limits<int>::max()));
+        }
+        else if (argument == "--count")
+        {
+            options.tableCount = parseIntegerOption(argument, nextValue(), 1);
+        }
+        else if (argument == "--permutation")
+        {
+            options.permutationName = nextValue();
+        }
+        else if (argument == "--check")
+        {
+            options.checkName = nextValue();
+        }
+        else if (argument == "--out")
+        {
+            options.outputFileName = nextValue();
+        }
+        else if (argument == "--seed")
+        {
+            options.seed = static_cast<std::uint32_t>(
+                parseIntegerOption(argument, nextValue(), 0, std::numeric_limits<std::uint32_t>::max()));
+        }
+        else if (argument == "--threads")
+        {
+            options.threadCount = static_cast<unsigned>(
+                parseIntegerOption(argument, nextValue(), 1, std::numeric_limits<unsigned>::max()));
+        }
+        else if (argument == "--jobs")
+        {
+            options.jobCount = static_cast<unsigned>(
+                parseIntegerOption(argument, nextValue(), 1, std::numeric_limits<unsigned>::max()));
+        }
+        else if (argument == "--input")
+        {
+            options.inputCorpusName = nextValue();
+        }
+        else if (argument == "--corpus-out")
+        {
+            options.outputCorpusName = nextValue();
+        }
+        else if (argument == "--formula")
+        {
+            options.useFormula = true;
+        }
+        else if (argument == "--counters-out")
+        {
+            options.countersFileName = nextValue();
+            if (!QUASIGROUP_ENABLE_COUNTERS)
+            {
+                throw std::invalid_argument("--counters-out требует сборки с -DQUASIGROUP_ENABLE_COUNTERS=1");
+            }
+        }
+        else if (argument == "--moves")
+        {
+            options.moveCount = parseIntegerOption(argument, nextValue(), 1);
+        }
+        else if (argument == "--shards")
+        {
+            options.shardCount = parseIntegerOption(argument, nextValue(), 1);
+        }
+        else if (argument == "--shard")
+        {
+            options.shardIndex = parseIntegerOption(argument, nextValue(), 0);
+        }
+        else if (argument == "--shard-dir")
+        {
+            options.shardDirectory = nextValue();
+        }
+        else if (argument == "--field")
+        {
+            std::string field = nextValue();
+            std::size_t separator = field.find('^');
+            constexpr long long maximumInt = std::numeric_limits<int>::max();
+            options.fieldCharacteristic =
+                static_cast<int>(parseIntegerOption(argument, field.substr(0, separator), 2, maximumInt));
+            options.fieldDegree =
+                separator == std::string::npos
+                    ? 1
+                    : static_cast<int>(parseIntegerOption(argument, field.substr(separator + 1), 1, maximumInt));
+        }
+        else
+        {
+            throw std::invalid_argument("Неизвестный параметр " + argument);
+        }
+    }
+    if (options.fieldDegree > 0)
+    {
+        if (options.generatorName != "affine" && options.generatorName != "affine-sweep")
+        {
+            throw std::invalid_argument("--field поддерживает только --generate affine и affine-sweep");
+        }
+        long long fieldOrder = 1;
+        for (int power = 0; power < options.fieldDegree && fieldOrder <= GaloisField::maximumOrder; ++power)
+        {
+            fieldOrder *= options.fieldCharacteristic;
+        }
+        if (fieldOrder > GaloisField::maximumOrder || (options.order > 0 && options.order != fieldOrder))
+        {
+            throw std::invalid_argument("Порядок поля --field должен быть не больше 2^24 и совпадать с --order");
+        }
+        options.order = static_cast<int>(fieldOrder);
+    }
+    if (!options.inputCorpusName.empty())
+    {
+        if (!options.generatorName.empty() || !options.outputCorpusName.empty())
+        {
+            throw std::invalid_argument("--input нельзя совмещать с --generate и --corpus-out");
+        }
+    }
+    else if (options.generatorName != "cyclic" && options.generatorName != "affine" &&
+             options.generatorName != "affine-sweep" && options.generatorName != "srg" && options.generatorName != "jm")
+    {
+        throw std::invalid_argument("Укажите генератор: --generate cyclic|affine|affine-sweep|srg|jm или корпус: --input");
+    }
+    if (options.moveCount > 0 && options.generatorName != "jm")
+    {
+        throw std::invalid_argument("--moves используется только с --generate jm");
+    }
+    if (options.permutationName != "identity" && options.permutationName != "random")
+    {
+        throw std::invalid_argument("Некорректное значение --permutation: " + options.permutationName);
+    }
+    if (options.useFormula &&
+        (options.generatorName == "srg" || options.generatorName == "jm" || !options.inputCorpusName.empty() || !options.outputCorpusName.empty() ||
+         (options.generatorName == "affine-sweep" && options.permutationName != "identity")))
+    {
+        throw std::invalid_argument("--formula поддерживает только cyclic, affine и affine-sweep с --permutation identity "
+                                    "и не совмещается с --input и --corpus-out");
+    }
+    if (options.jobCount > 1 &&
+        (options.useFormula || options.generatorName == "affine-sweep" || options.generatorName == "jm" ||
+         options.threadCount > 1))
+    {
+        throw std::invalid_argument("--jobs поддерживает только --generate cyclic, affine, srg и --input без --formula "
+                                    "и не совмещается с --threads");
+    }
+    if (options.order <= 0 && options.inputCorpusName.empty())
+    {
+        throw std::invalid_argument("Укажите порядок: --order N");
+    }
+    if (options.shardCount > 0 &&
+        (!options.seed || !options.inputCorpusName.empty() || !options.outputCorpusName.empty()))
+    {
+        throw std::invalid_argument("--shards требует --seed и не совмещается с --input и --corpus-out");
+    }
+    // Цепь jm одна на весь запуск: каждому шарду пришлось бы заново пройти шаги всех предыдущих шардов.
+    if (options.shardCount > 0 && options.generatorName == "jm")
+    {
+        throw std::invalid_argument("--shards не поддерживает --generate jm");
+    }
+    if (options.shardCount > (1LL << 31))
+    {
+        throw std::invalid_argument("--shards K требует K <= 2^31");
+    }
+    if (options.shardIndex && *options.shardIndex >= options.shardCount)
+    {
+        throw std::invalid_argument("--shard I требует --shards K с I < K");
+    }
+    if (options.checkName != "proper" && options.checkName != "nontrivial" && options.checkName != "both" &&
+        options.checkName != "none")
+    {
+        throw std::invalid_argument("Некорректное значение --check: " + options.checkName);
+    }
+    return options;
+}
+
+// Генерирует очередную таблицу пакетного режима; аффинные параметры выбираются случайно.
+// Параметры:
+//   options: Параметры пакетного режима.
+//   field: Поле для affine с --field или nullptr.
+//   cayleyTable: Таблица для результата; буфер переиспользуется от таблицы к таблице.
+//   parameters: Если не nullptr, получает alpha, beta, c аффинной таблицы (записи .qgr); f не сохраняется,
+//               ее восстанавливают номер таблицы и зерно.
+void generateBatchTable(const BatchOptions &options, const GaloisField *field, CayleyTable &cayleyTable,
+                        BatchResultRecord *parameters = nullptr)
+{
+    int order = options.order;
+    auto setParameters = [&](int coefficientAlpha, int coefficientBeta, int constantC)
+    {
+        if (parameters)
+        {
+            parameters->coefficientAlpha = coefficientAlpha;
+            parameters->coefficientBeta = coefficientBeta;
+            parameters->constantC = constantC;
+        }
+    };
+    if (options.generatorName == "cyclic")
+    {
+        generateCyclicGroupCayleyTable(order, cayleyTable);
+        setParameters(1, 1, 0);
+        return;
+    }
+    if (field)
+    {
+        std::uniform_int_distribution<int> nonZeroElement(1, order - 1);
+        int coefficientAlpha = nonZeroElement(getRandomNumberGenerator());
+        int coefficientBeta = nonZeroElement(getRandomNumberGenerator());
+        int constantC = std::uniform_int_distribution<int>(0, order - 1)(getRandomNumberGenerator());
+        generateAffineFieldQuasigroupCayleyTable(*field, coefficientAlpha, coefficientBeta, constantC,
+                                                 generateRandomPermutation(order), cayleyTable);
+        setParameters(coefficientAlpha, coefficientBeta, constantC);
+        return;
+    }
+    if (options.generatorName == "affine")
+    {
+        int coefficientAlpha = selectRandomCoprimeCoefficient(order);
+        int coefficientBeta = selectRandomCoprimeCoefficient(order);
+        int constantC = std::uniform_int_distribution<int>(0, order - 1)(getRandomNumberGenerator());
+        generateAffineQuasigroupCayleyTable(order, coefficientAlpha, coefficientBeta, constantC,
+                                            generateRandomPermutation(order), cayleyTable);
+        setParameters(coefficientAlpha, coefficientBeta, constantC);
+        return;
+    }
+    generateSequentialReplacementGraphCayleyTable(order, cayleyTable);
+}
+
+// Параметр options: Параметры пакетного режима.
+// Возвращает: Число единиц работы, делимых между шардами: пар (alpha, beta) для affine-sweep
+// и таблиц для остальных генераторов.
+long long countBatchWorkUnits(const BatchOptions &options)
+{
+    if (options.generatorName != "affine-sweep")
+    {
+        return options.tableCount;
+    }
+    if (options.fieldDegree > 0)
+    {
+        return static_cast<long long>(options.order - 1) * (options.order - 1);
+    }
+    long long coefficientCount = 0;
+    for (int coefficient = options.order == 1 ? 0 : 1; coefficient < options.order; ++coefficient)
+    {
+        coefficientCount += computeGreatestCommonDivisor(coefficient, options.order) == 1;
+    }
+    return coefficientCount * coefficientCount;
+}
+
+// Итоги пакетного запуска или одного шарда.
+struct BatchSummary
+{
+    long long tableCount = 0;      // Проверенных таблиц.
+    long long properCount = 0;     // Таблиц с собственными подквазигруппами.
+    long long nonTrivialCount = 0; // Таблиц с нетривиальными подквазигруппами.
+};
+
+// Генерирует и проверяет единицы работы [firstWorkUnit, endWorkUnit) пакетного режима (все — без шардов).
+// Номер таблицы и ее поток случайных чисел не зависят от диапазона, поэтому строки результатов шардов
+// совпадают со строками запуска без разбиения. Цепь jm последовательна: шаги таблиц до firstWorkUnit
+// повторяются без проверки.
+// С --input таблицы читаются из корпуса в фоновом потоке одновременно с проверкой, память постоянна.
+// Параметр options: Параметры пакетного режима.
+// Возвращает: Итоги запуска.
+// Выбрасывает: std::runtime_error, если файл результатов или корпус не удалось открыть или корпус поврежден.
+BatchSummary runBatchWorkUnits(const BatchOptions &options)
+{
+    // Таблица с номером i строится из потока случайных чисел (masterSeed, i); перестановка affine-sweep — из
+    // самого главного зерна.
+    std::uint64_t masterSeed = options.seed ? *options.seed : std::random_device{}();
+    getRandomNumberGenerator().seed(static_cast<std::uint32_t>(masterSeed));
+    std::ofstream output;
+    std::optional<BatchResultWriter> resultWriter;
+    if (hasBatchResultExtension(options.outputFileName))
+    {
+        resultWriter.emplace(options.outputFileName);
+    }
+    else if (!options.outputFileName.empty())
+    {
+        output.open(options.outputFileName);
+        if (!output)
+        {
+            throw std::runtime_error("Не удалось открыть файл для записи");
+        }
+    }
+    // Свидетели и хеши таблиц нужны только записям .qgr.
+    bool collectsWitnesses = resultWriter.has_value();
+    std::optional<CayleyTableCorpusWriter> corpusWriter;
+    if (!options.outputCorpusName.empty())
+    {
+        corpusWriter.emplace(options.outputCorpusName);
+    }
+    bool isSweep = options.generatorName == "affine-sweep";
+    long long firstWorkUnit = options.firstWorkUnit;
+    long long endWorkUnit = options.endWorkUnit >= 0 ? options.endWorkUnit : countBatchWorkUnits(options);
+    // Пара (alpha, beta) дает n таблиц, по одной на c.
+    long long firstIndex = isSweep ? firstWorkUnit * options.order : firstWorkUnit;
+    if (output.is_open())
+    {
+        output << (isSweep ? "# index order proper nontrivial alpha beta c\n" : "# index order proper nontrivial\n");
+    }
+    WorkStealingThreadPool threadPool(options.threadCount);
+    std::shared_ptr<const GaloisField> field;
+    if (options.fieldDegree > 0)
+    {
+        field = std::make_shared<const GaloisField>(options.fieldCharacteristic, options.fieldDegree);
+    }
+    bool checkProper = options.checkName == "proper" || options.checkName == "both";
+    bool checkNonTrivial = options.checkName == "nontrivial" || options.checkName == "both";
+    long long tableCount = 0, properCount = 0, nonTrivialCount = 0;
+    // Учитывает вердикты таблицы и записывает ее строку или запись .qgr. Параметры alpha, beta, c попадают
+    // в текстовую строку только для affine-sweep, в запись .qgr — всегда, когда известны.
+    auto recordVerdicts = [&](BatchResultRecord &record)
+    {
+        properCount += record.hasProperSubquasigroups;
+        nonTrivialCount += record.hasNonTrivialSubquasigroups;
+        record.tableId = static_cast<std::uint64_t>(firstIndex + tableCount++);
+        record.checksProper = checkProper;
+        record.checksNonTrivial = checkNonTrivial;
+        if (resultWriter)
+        {
+            QUASIGROUP_TIME_PHASE(write);
+            resultWriter->append(record);
+        }
+        else if (output.is_open())
+        {
+            QUASIGROUP_TIME_PHASE(write);
+            output << record.tableId << ' ' << record.order << ' '
+                   << (checkProper ? (record.hasProperSubquasigroups ? "1" : "0") : "-") << ' '
+                   << (checkNonTrivial ? (record.hasNonTrivialSubquasigroups ? "1" : "0") : "-");
+            if (isSweep)
+            {
+                output << ' ' << record.coefficientAlpha << ' ' << record.coefficientBeta << ' ' << record.constantC;
+            }
+            output << '\n';
+        }
+    };
+    auto analyzeFormula = [&](const auto &quasigroup, int coefficientAlpha = -1, int coefficientBeta = -1,
+                              int constantC = -1)
+    {
+        BatchResultRecord record;
+        record.order = quasigroup.getOrder();
+        record.coefficientAlpha = coefficientAlpha;
+        record.coefficientBeta = coefficientBeta;
+        record.constantC = constantC;
+        SubquasigroupAnalysis analysis;
+        if (checkProper || checkNonTrivial)
+        {
+            analysis = quasigroup.analyzeSubquasigroups();
+            record.hasProperSubquasigroups = checkProper && analysis.hasProperSubquasigroups;
+            record.hasNonTrivialSubquasigroups = checkNonTrivial && analysis.hasNonTrivialSubquasigroups;
+            record.witnesses = &analysis;
+        }
+        recordVerdicts(record);
+    };
+    // Проверяет таблицу; безопасно для параллельных вызовов с разными pool.
+    auto checkTable = [&](CayleyTableView cayleyTable, WorkStealingThreadPool &pool,
+                          SubquasigroupAnalysis *witnesses = nullptr)
+    {
+        QUASIGROUP_TIME_PHASE(analyze);
+        return checkSubquasigroups(cayleyTable, checkProper, checkNonTrivial, pool, witnesses);
+    };
+    auto analyzeTable = [&](CayleyTable &cayleyTable, int coefficientAlpha = -1, int coefficientBeta = -1,
+                            int constantC = -1)
+    {
+        // Таблицы корпуса проверяются при чтении, сгенерированные — здесь.
+        if (options.inputCorpusName.empty())
+        {
+            QUASIGROUP_TIME_PHASE(validate);
+            validateLatinSquare(cayleyTable);
+        }
+        if (corpusWriter)
+        {
+            QUASIGROUP_TIME_PHASE(write);
+            corpusWriter->append(cayleyTable);
+        }
+        BatchResultRecord record;
+        record.order = cayleyTable.getOrder();
+        record.coefficientAlpha = coefficientAlpha;
+        record.coefficientBeta = coefficientBeta;
+        record.constantC = constantC;
+        SubquasigroupAnalysis witnesses;
+        if (collectsWitnesses)
+        {
+            record.tableHash = computeFnv1a64(cayleyTable.data(), cayleyTable.getByteSize());
+            record.witnesses = &witnesses;
+        }
+        SubquasigroupVerdicts verdicts = checkTable(cayleyTable, threadPool, collectsWitnesses ? &witnesses : nullptr);
+        record.hasProperSubquasigroups = verdicts.hasProperSubquasigroups;
+        record.hasNonTrivialSubquasigroups = verdicts.hasNonTrivialSubquasigroups;
+        recordVerdicts(record);
+    };
+    if (!options.inputCorpusName.empty() && options.jobCount > 1)
+    {
+        // Таблицы корпуса читаются в пакеты до 4096 таблиц или 64 МиБ и проверяются всеми потоками сразу,
+        // по таблице на задачу; вердикты пакета записываются по порядку.
+        constexpr std::size_t maximumBatchTables = 4096, maximumBatchBytes = std::size_t(64) << 20;
+        PrefetchingCayleyTableCorpusReader corpusReader(options.inputCorpusName);
+        WorkStealingThreadPool jobPool(options.jobCount);
+        SubquasigroupBatchChecker batch;
+        auto readNext = [&](CayleyTable &cayleyTable)
+        {
+            QUASIGROUP_TIME_PHASE(read);
+            return corpusReader.readNext(cayleyTable);
+        };
+        for (bool hasMoreTables = true; hasMoreTables;)
+        {
+            batch.clear();
+            while (batch.size() < maximumBatchTables && batch.getByteSize() < maximumBatchBytes &&
+                   (hasMoreTables = readNext(batch.getNext())))
+            {
+                batch.commitNext();
+            }
+            const std::vector<SubquasigroupVerdicts> &verdicts =
+                batch.check(jobPool, checkProper, checkNonTrivial, collectsWitnesses);
+            for (std::size_t index = 0; index < batch.size(); ++index)
+            {
+                CayleyTableView table = batch.getTable(index);
+                BatchResultRecord record;
+                record.order = table.getOrder();
+                record.hasProperSubquasigroups = verdicts[index].hasProperSubquasigroups;
+                record.hasNonTrivialSubquasigroups = verdicts[index].hasNonTrivialSubquasigroups;
+                if (collectsWitnesses)
+                {
+                    record.tableHash = computeFnv1a64(table.data(), table.getByteSize());
+                    record.witnesses = &batch.getWitnesses(index);
+                }
+                recordVerdicts(record);
+            }
+        }
+    }
+    else if (!options.inputCorpusName.empty())
+    {
+        PrefetchingCayleyTableCorpusReader corpusReader(options.inputCorpusName);
+        CayleyTable cayleyTable;
+        auto readNext = [&]
+        {
+            QUASIGROUP_TIME_PHASE(read);
+            return corpusReader.readNext(cayleyTable);
+        };
+        while (readNext())
+        {
+            analyzeTable(cayleyTable);
+        }
+    }
+    else if (options.useFormula && isSweep && field)
+    {
+        int order = options.order;
+        long long pairIndex = 0;
+        for (int coefficientAlpha = 1; coefficientAlpha < order && pairIndex < endWorkUnit; ++coefficientAlpha)
+        {
+            for (int coefficientBeta = 1; coefficientBeta < order && pairIndex < endWorkUnit; ++coefficientBeta)
+            {
+                if (pairIndex++ < firstWorkUnit)
+                {
+                    continue;
+                }
+                for (int constantC = 0; constantC < order; ++constantC)
+                {
+                    analyzeFormula(AffineFieldQuasigroup(field, coefficientAlpha, coefficientBeta, constantC),
+                                   coefficientAlpha, coefficientBeta, constantC);
+                }
+            }
+        }
+    }
+    else if (options.useFormula && isSweep)
+    {
+        int order = options.order, firstCoefficient = order == 1 ? 0 : 1;
+        long long pairIndex = 0;
+        for (int coefficientAlpha = firstCoefficient; coefficientAlpha < order && pairIndex < endWorkUnit;
+             ++coefficientAlpha)
+        {
+            for (int coefficientBeta = firstCoefficient; coefficientBeta < order && pairIndex < endWorkUnit;
+                 ++coefficientBeta)
+            {
+                if (computeGreatestCommonDivisor(coefficientAlpha, order) != 1 ||
+                    computeGreatestCommonDivisor(coefficientBeta, order) != 1 || pairIndex++ < firstWorkUnit)
+                {
+                    continue;
+                }
+                for (int constantC = 0; constantC < order; ++constantC)
+                {
+                    analyzeFormula(AffineFormulaQuasigroup(order, coefficientAlpha, coefficientBeta, constantC),
+                                   coefficientAlpha, coefficientBeta, constantC);
+                }
+            }
+        }
+    }
+    else if (options.useFormula)
+    {
+        for (long long tableIndex = firstWorkUnit; tableIndex < endWorkUnit; ++tableIndex)
+        {
+            seedRandomNumberStream(masterSeed, static_cast<std::uint64_t>(tableIndex));
+            int order = options.order;
+            if (options.generatorName == "cyclic")
+            {
+                analyzeFormula(AffineFormulaQuasigroup::cyclicGroup(order), 1, 1, 0);
+            }
+            else if (field)
+            {
+                std::uniform_int_distribution<int> nonZeroElement(1, order - 1);
+                int coefficientAlpha = nonZeroElement(getRandomNumberGenerator());
+                int coefficientBeta = nonZeroElement(getRandomNumberGenerator());
+                int constantC = std::uniform_int_distribution<int>(0, order - 1)(getRandomNumberGenerator());
+                analyzeFormula(AffineFieldQuasigroup(field, coefficientAlpha, coefficientBeta, constantC),
+                               coefficientAlpha, coefficientBeta, constantC);
+            }
+            else
+            {
+                int coefficientAlpha = selectRandomCoprimeCoefficient(order);
+                int coefficientBeta = selectRandomCoprimeCoefficient(order);
+                int constantC = std::uniform_int_distribution<int>(0, order - 1)(getRandomNumberGenerator());
+                analyzeFormula(AffineFormulaQuasigroup(order, coefficientAlpha, coefficientBeta, constantC),
+                               coefficientAlpha, coefficientBeta, constantC);
+            }
+        }
+    }
+    else if (isSweep)
+    {
+        std::vector<int> permutationFunction(options.order);
+        std::iota(permutationFunction.begin(), permutationFunction.end(), 0);
+        if (options.permutationName == "random")
+        {
+            permutationFunction = generateRandomPermutation(options.order);
+        }
+        auto visitSweptTable = [&](int coefficientAlpha, int coefficientBeta, int constantC, const CayleyTable &cayleyTable)
+        {
+            CayleyTable sweptTable = CayleyTable::borrow(cayleyTable);
+            analyzeTable(sweptTable, coefficientAlpha, coefficientBeta, constantC);
+            return true;
+        };
+        if (field)
+        {
+            sweepAffineFieldQuasigroups(*field, permutationFunction, visitSweptTable, firstWorkUnit, endWorkUnit);
+        }
+        else
+        {
+            sweepAffineQuasigroups(options.order, permutationFunction, visitSweptTable, firstWorkUnit, endWorkUnit);
+        }
+    }
+    else if (options.generatorName == "jm")
+    {
+        // Одна цепь на весь запуск (поэтому jm не разбивается на шарды): квадрат меняется на месте, и каждая
+        // таблица копируется в один и тот же буфер. Прогрев идет из главного зерна, шаги перед таблицей i — из
+        // потока (masterSeed, i).
+        long long order = options.order;
+        JacobsonMatthewsSampler sampler(generateCyclicGroupCayleyTable(options.order));
+        sampler.advance(order * order);
+        long long stepCount = options.moveCount > 0 ? options.moveCount : order;
+        CayleyTable cayleyTable(options.order);
+        for (long long tableIndex = 0; tableIndex < endWorkUnit; ++tableIndex)
+        {
+            seedRandomNumberStream(masterSeed, static_cast<std::uint64_t>(tableIndex));
+            {
+                QUASIGROUP_TIME_PHASE(generate);
+                sampler.advance(stepCount);
+                sampler.copyTo(cayleyTable);
+            }
+            analyzeTable(cayleyTable);
+        }
+    }
+    else if (options.jobCount > 1)
+    {
+        // Таблицы обрабатываются блоками: потоки пула генерируют и проверяют таблицы блока, затем результаты
+        // записываются по порядку номеров. Каждому потоку — свой однопоточный пул для проверок.
+        struct TableResult
+        {
+            BatchResultRecord record;
+            SubquasigroupAnalysis witnesses; // Только для .qgr.
+            CayleyTable table; // Сохраняется только для --corpus-out.
+            std::exception_ptr error;
+        };
+        WorkStealingThreadPool jobPool(options.jobCount);
+        std::vector<std::unique_ptr<WorkStealingThreadPool>> checkPools;
+        for (unsigned job = 0; job < jobPool.getWorkerCount(); ++job)
+        {
+            checkPools.push_back(std::make_unique<WorkStealingThreadPool>(1));
+        }
+        std::size_t tableBytes = CayleyTable(options.order).getByteSize();
+        std::size_t blockSize = 64 * static_cast<std::size_t>(jobPool.getWorkerCount());
+        if (corpusWriter)
+        {
+            blockSize = std::max<std::size_t>(jobPool.getWorkerCount(),
+                                              std::min(blockSize, (std::size_t(256) << 20) / std::max<std::size_t>(tableBytes, 1)));
+        }
+        std::vector<TableResult> results;
+        for (long long blockStart = firstWorkUnit; blockStart < endWorkUnit; blockStart += static_cast<long long>(blockSize))
+        {
+            std::size_t blockCount = static_cast<std::size_t>(
+                std::min<long long>(static_cast<long long>(blockSize), endWorkUnit - blockStart));
+            results.assign(blockCount, TableResult());
+            jobPool.run(blockCount, [&](std::size_t offset, unsigned job)
+                        {
+                            TableResult &result = results[offset];
+                            try
+                            {
+                                seedRandomNumberStream(masterSeed, static_cast<std::uint64_t>(blockStart) + offset);
+                                CayleyTable cayleyTable;
+                                {
+                                    QUASIGROUP_TIME_PHASE(generate);
+                                    generateBatchTable(options, field.get(), cayleyTable, &result.record);
+                                }
+                                {
+                                    QUASIGROUP_TIME_PHASE(validate);
+                                    validateLatinSquare(cayleyTable);
+                                }
+                                result.record.order = cayleyTable.getOrder();
+                                if (collectsWitnesses)
+                                {
+                                    result.record.tableHash = computeFnv1a64(cayleyTable.data(), cayleyTable.getByteSize());
+                                }
+                                if (corpusWriter)
+                                {
+                                    result.table = cayleyTable;
+                                }
+                                SubquasigroupVerdicts verdicts = checkTable(
+                                    cayleyTable, *checkPools[job], collectsWitnesses ? &result.witnesses : nullptr);
+                                result.record.hasProperSubquasigroups = verdicts.hasProperSubquasigroups;
+                                result.record.hasNonTrivialSubquasigroups = verdicts.hasNonTrivialSubquasigroups;
+                            }
+                            catch (...)
+                            {
+                                result.error = std::current_exception();
+                                return false;
+                            }
+                            return true; });
+            // Отмененные после ошибки задачи не заполнены, поэтому ошибка блока проверяется до записи.
+            for (const TableResult &result : results)
+            {
+                if (result.error)
+                {
+                    std::rethrow_exception(result.error);
+                }
+            }
+            for (TableResult &result : results)
+            {
+                if (corpusWriter)
+                {
+                    QUASIGROUP_TIME_PHASE(write);
+                    corpusWriter->append(result.table);
+                }
+                if (collectsWitnesses)
+                {
+                    result.record.witnesses = &result.witnesses;
+                }
+                recordVerdicts(result.record);
+            }
+        }
+    }
+    else
+    {
+        CayleyTable cayleyTable;
+        for (long long tableIndex = firstWorkUnit; tableIndex < endWorkUnit; ++tableIndex)
+        {
+            seedRandomNumberStream(masterSeed, static_cast<std::uint64_t>(tableIndex));
+            BatchResultRecord parameters;
+            {
+                QUASIGROUP_TIME_PHASE(generate);
+                generateBatchTable(options, field.get(), cayleyTable, &parameters);
+            }
+            analyzeTable(cayleyTable, parameters.coefficientAlpha, parameters.coefficientBeta, parameters.constantC);
+        }
+    }
+    if (resultWriter)
+    {
+        resultWriter->flush();
+    }
+    // Ошибка записи в текстовый --out иначе прошла бы незамеченной, и обрезанный файл шарда получил бы отметку.
+    if (output.is_open() && !output.flush())
+    {
+        throw std::runtime_error("Не удалось записать файл результатов " + options.outputFileName);
+    }
+    BatchSummary summary;
+    summary.tableCount = tableCount;
+    summary.properCount = properCount;
+    summary.nonTrivialCount = nonTrivialCount;
+    return summary;
+}
+
+// Выводит итоги пакетного запуска.
+// Параметры:
+//   options: Параметры пакетного режима (выбор проверок).
+//   summary: Итоги.
+//   elapsedSeconds: Время запуска.
+void printBatchSummary(const BatchOptions &options, const BatchSummary &summary, double elapsedSeconds)
+{
+    std::cout << "Таблиц: " << summary.tableCount << "\n";
+    if (options.checkName == "proper" || options.checkName == "both")
+    {
+        std::cout << "С собственными подквазигруппами: " << summary.properCount << "\n";
+    }
+    if (options.checkName == "nontrivial" || options.checkName == "both")
+    {
+        std::cout << "С нетривиальными подквазигруппами: " << summary.nonTrivialCount << "\n";
+    }
+    std::cout << "Время: " << elapsedSeconds << " с\n";
+}
+
+// Описывает параметры, от которых зависят строки результатов шардов. Описание записывается в последнюю
+// строку файла шарда, чтобы повторный запуск с другими параметрами не принял чужой шард за готовый.
+// Параметр options: Параметры пакетного режима.
+// Возвращает: Строку вида "generate=srg order=8 ...".
+std::string describeShardedCampaign(const BatchOptions &options)
+{
+    std::string description = "generate=" + options.generatorName + " order=" + std::to_string(options.order) +
+                              " check=" + options.checkName + " seed=" + std::to_string(*options.seed);
+    if (options.generatorName == "affine-sweep")
+    {
+        description += " permutation=" + options.permutationName;
+    }
+    else
+    {
+        description += " count=" + std::to_string(options.tableCount);
+    }
+    if (options.fieldDegree > 0)
+    {
+        description += " field=" + std::to_string(options.fieldCharacteristic) + "^" + std::to_string(options.fieldDegree);
+    }
+    if (options.useFormula)
+    {
+        description += " formula";
+    }
+    return description;
+}
+
+// Читает итоги готового шарда из его файла-отметки с одной строкой
+// "# shard I of K tables T proper P nontrivial N campaign ОПИСАНИЕ".
+// Параметры:
+//   markerName: Файл-отметка шарда (.done).
+//   trailerPrefix: Ожидаемое начало строки, "# shard I of K".
+//   campaign: Описание запуска (describeShardedCampaign).
+// Возвращает: Итоги шарда или пустое значение, если отметки нет (шард не выполнен).
+// Выбрасывает: std::runtime_error, если отметка повреждена или записана запуском с другими параметрами.
+std::optional<BatchSummary> readCompletedShard(const std::string &markerName, const std::string &trailerPrefix,
+                                               const std::string &campaign)
+{
+    std::ifstream file(markerName);
+    if (!file)
+    {
+        return std::nullopt;
+    }
+    std::string trailer;
+    std::getline(file, trailer);
+    BatchSummary summary;
+    std::size_t campaignStart = trailer.find(" campaign ");
+    if (trailer.compare(0, trailerPrefix.size(), trailerPrefix) != 0 || campaignStart == std::string::npos ||
+        std::sscanf(trailer.c_str() + trailerPrefix.size(), " tables %lld proper %lld nontrivial %lld",
+                    &summary.tableCount, &summary.properCount, &summary.nonTrivialCount) != 3)
+    {
+        throw std::runtime_error("Отметка шарда " + markerName + " повреждена");
+    }
+    if (trailer.compare(campaignStart + 10, std::string::npos, campaign) != 0)
+    {
+        throw std::runtime_error("Шард " + markerName + " записан запуском с другими параметрами");
+    }
+    return summary;
+}
+
+// Сбрасывает записанный файл на диск, чтобы после сбоя питания отметка шарда не осталась без его данных.
+// Параметр fileName: Имя файла.
+// Выбрасывает: std::runtime_error, если файл не открылся или fsync не удался.
+void syncFileToDisk(const std::string &fileName)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    int descriptor = open(fileName.c_str(), O_RDONLY);
+    bool isSynced = descriptor >= 0 && fsync(descriptor) == 0;
+    if (descriptor >= 0)
+    {
+        close(descriptor);
+    }
+    if (!isSynced)
+    {
+        throw std::runtime_error("Не удалось сбросить на диск файл " + fileName);
+    }
+#else
+    (void)fileName;
+#endif
+}
+
+// Выполняет пакетный режим с --shards K: единицы работы countBatchWorkUnits делятся на K непрерывных диапазонов,
+// шард s — единицы [s * U / K, (s + 1) * U / K). Шард пишется в DIR/shard-s-of-K.txt (.qgr, если --out —
+// файл .qgr), затем рядом атомарно (через переименование) появляется отметка shard-s-of-K.txt.done с итогами.
+// Поэтому после сбоя узла шард без отметки считается невыполненным и при повторном запуске пишется заново,
+// а готовые пропускаются. С --shard I выполняется только шард I, так что шарды можно раздать разным узлам
+// с общим каталогом. Когда готовы все шарды, они по порядку собираются в --out.
+// Параметр options: Параметры пакетного режима.
+// Возвращает: Суммарные итоги готовых шардов.
+// Выбрасывает: std::runtime_error, если каталог или файлы шардов недоступны или шард чужого запуска.
+BatchSummary runShardedBatch(const BatchOptions &options)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    if (mkdir(options.shardDirectory.c_str(), 0777) != 0 && errno != EEXIST)
+    {
+        throw std::runtime_error("Не удалось создать каталог шардов " + options.shardDirectory);
+    }
+#endif
+    long long workUnitCount = countBatchWorkUnits(options);
+    std::string campaign = describeShardedCampaign(options);
+    bool writesRecords = hasBatchResultExtension(options.outputFileName);
+    // floor(U * s / K) без 128-битного произведения: (U % K) * s < K^2 <= 2^62 (K <= 2^31, см. parseBatchOptions).
+    auto shardBoundary = [&](long long shard)
+    {
+        return workUnitCount / options.shardCount * shard + workUnitCount % options.shardCount * shard / options.shardCount;
+    };
+    auto shardFileName = [&](long long shard)
+    {
+        return options.shardDirectory + "/shard-" + std::to_string(shard) + "-of-" +
+               std::to_string(options.shardCount) + (writesRecords ? ".qgr" : ".txt");
+    };
+    BatchSummary total;
+    long long readyCount = 0, completedCount = 0, skippedCount = 0;
+    for (long long shard = 0; shard < options.shardCount; ++shard)
+    {
+        std::string fileName = shardFileName(shard), markerName = fileName + ".done";
+        std::string trailerPrefix = "# shard " + std::to_string(shard) + " of " + std::to_string(options.shardCount);
+        std::optional<BatchSummary> summary = readCompletedShard(markerName, trailerPrefix, campaign);
+        bool isSelected = !options.shardIndex || *options.shardIndex == shard;
+        if (summary && isSelected)
+        {
+            ++skippedCount;
+        }
+        else if (isSelected)
+        {
+            BatchOptions shardOptions = options;
+            shardOptions.shardCount = 0;
+            shardOptions.shardIndex.reset();
+            shardOptions.outputFileName = fileName;
+            shardOptions.firstWorkUnit = shardBoundary(shard);
+            shardOptions.endWorkUnit = shardBoundary(shard + 1);
+            summary = runBatchWorkUnits(shardOptions);
+            syncFileToDisk(fileName);
+            std::string partName = markerName + ".part";
+            {
+                std::ofstream marker(partName);
+                marker << trailerPrefix << " tables " << summary->tableCount << " proper " << summary->properCount
+                       << " nontrivial " << summary->nonTrivialCount << " campaign " << campaign << '\n';
+                if (!marker.flush())
+                {
+                    throw std::runtime_error("Не удалось записать отметку шарда " + partName);
+                }
+            }
+            syncFileToDisk(partName);
+            if (std::rename(partName.c_str(), markerName.c_str()) != 0)
+            {
+                throw std::runtime_error("Не удалось переименовать отметку шарда " + partName);
+            }
+            ++completedCount;
+        }
+        if (summary)
+        {
+            ++readyCount;
+            total.tableCount += summary->tableCount;
+            total.properCount += summary->properCount;
+            total.nonTrivialCount += summary->nonTrivialCount;
+        }
+    }
+    std::cout << "Шардов: " << options.shardCount << ", готово: " << readyCount << " (выполнено сейчас: "
+              << completedCount << ", пропущено готовых: " << skippedCount << ")\n";
+    if (options.outputFileName.empty())
+    {
+        return total;
+    }
+    if (readyCount < options.shardCount)
+    {
+        std::cout << "Файл " << options.outputFileName << " будет собран, когда будут готовы все шарды\n";
+        return total;
+    }
+    // Текстовые шарды склеиваются без строк заголовка, двоичные — без 16-байтовых заголовков файлов.
+    std::ofstream output(options.outputFileName, std::ios::binary);
+    if (!output)
+    {
+        throw std::runtime_error("Не удалось открыть файл для записи");
+    }
+    std::vector<char> buffer(std::size_t(1) << 20);
+    for (long long shard = 0; shard < options.shardCount; ++shard)
+    {
+        std::ifstream shardFile(shardFileName(shard), std::ios::binary);
+        if (!shardFile)
+        {
+            throw std::runtime_error("Не удалось открыть файл шарда " + shardFileName(shard));
+        }
+        if (writesRecords ? shard > 0 && !shardFile.ignore(static_cast<std::streamsize>(batchResultHeaderSize))
+                          : shard > 0 && !shardFile.ignore(std::numeric_limits<std::streamsize>::max(), '\n'))
+        {
+            throw std::runtime_error("Файл шарда " + shardFileName(shard) + " поврежден");
+        }
+        while (shardFile.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || shardFile.gcount() > 0)
+        {
+            output.write(buffer.data(), shardFile.gcount());
+        }
+    }
+    if (!output.flush())
+    {
+        throw std::runtime_error("Не удалось записать файл результатов");
+    }
+    return total;
+}
+
+// Выполняет пакетный режим: генерирует и проверяет таблицы в одном процессе без меню (с --shards — по шардам,
+// см. runShardedBatch).
+// Параметр options: Параметры пакетного режима.
+// Возвращает: Код завершения программы.
+// Выбрасывает: std::runtime_error, если файл результатов или корпус не удалось открыть или корпус поврежден.
+int runBatch(const BatchOptions &options)
+{
+    auto startTime = std::chrono::steady_clock::now();
+    BatchSummary summary = options.shardCount > 0 ? runShardedBatch(options) : runBatchWorkUnits(options);
+    printBatchSummary(options, summary,
+                      std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count());
+#if QUASIGROUP_ENABLE_COUNTERS
+    if (!options.countersFileName.empty())
     {
-        for (int column = 0; column < order; ++column)
+        std::ofstream countersFile(options.countersFileName);
+        if (!countersFile)
         {
-            cayleyTable[row][column] = (coefficientAlpha * row + coefficientBeta * permutationFunction[column] + constantC) % order;
+            throw std::runtime_error("Не удалось открыть файл счетчиков для записи");
         }
+        writePerformanceCountersJson(countersFile);
     }
-    return cayleyTable;
+#endif
+    return 0;
 }
 
-// Генерирует таблицу Кэли с помощью метода последовательного графа замен.
-// Создает латинский квадрат, последовательно заполняя строки с учетом доступных символов.
-// Параметр order: Размер квазигруппы.
-// Возвращает: Вектор векторов, представляющий таблицу Кэли.
-class SequentialReplacementGraphGenerator
+// Возвращает: Пиковый размер резидентной памяти процесса в КиБ или -1, если он недоступен на платформе.
+long long getPeakResidentSetKibibytes()
 {
-    int order;                                               // Порядок квазигруппы.
-    std::vector<std::vector<int>> cayleyTable;               // Таблица Кэли, изначально заполнена -1.
-    std::vector<std::unordered_set<int>> availableInColumns; // Доступные символы для каждого столбца.
-    std::unordered_set<int> availableSymbols;                // Все возможные символы (0 до order-1).
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+    {
+#if defined(__APPLE__)
+        return usage.ru_maxrss / 1024;
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+#endif
+    return -1;
+}
 
-public:
-    // Инициализирует генератор для квазигруппы заданного порядка.
-    // Параметр order: Размер квазигруппы.
-    // Заполняет множество символов и доступные символы для столбцов.
-    explicit SequentialReplacementGraphGenerator(int order)
-        : order(order), cayleyTable(order, std::vector<int>(order, -1)), availableInColumns(order), availableSymbols()
+// Параметры режима --benchmark.
+struct BenchmarkOptions
+{
+    int minimumOrder = 8;          // Наименьший порядок; порядки удваиваются до maximumOrder.
+    int maximumOrder = 4096;       // Наибольший порядок.
+    int corpusSize = 3;            // Таблиц каждого генератора в корпусе для проверок.
+    double minimumSeconds = 0.2;   // Минимальное время замера одной операции.
+    std::uint32_t seed = 1;        // Зерно корпуса; корпус порядка n строится с зерном seed + n.
+    unsigned threadCount = 1;      // Потоки для проверок подквазигрупп.
+};
+
+// Выводит справку по параметрам режима --benchmark.
+// Параметр stream: Поток вывода.
+void printBenchmarkUsage(std::ostream &stream)
+{
+    stream << "Режим замеров (--benchmark):\n"
+           << "  --min-order N   Наименьший порядок (по умолчанию 8)\n"
+           << "  --max-order N   Наибольший порядок (по умолчанию 4096), порядки удваиваются\n"
+           << "  --corpus K      Таблиц affine и srg в корпусе каждого порядка (по умолчанию 3)\n"
+           << "  --min-time MS   Минимальное время замера в миллисекундах (по умолчанию 200)\n"
+           << "  --seed S        Зерно корпуса (по умолчанию 1)\n"
+           << "  --threads T     Потоки для проверок подквазигрупп (по умолчанию 1)\n"
+           << "Столбцы allocs/op и bytes/op заполняются в сборке с -DQUASIGROUP_TRACK_ALLOCATIONS=1.\n";
+}
+
+// Разбирает параметры режима --benchmark; argv[1] — сам параметр --benchmark.
+// Параметры argc, argv: Аргументы main.
+// Возвращает: Заполненные параметры.
+// Выбрасывает: std::invalid_argument при неизвестном или некорректном параметре.
+BenchmarkOptions parseBenchmarkOptions(int argc, char **argv)
+{
+    BenchmarkOptions options;
+    for (int index = 2; index < argc; ++index)
     {
-        for (int symbol = 0; symbol < order; ++symbol)
+        std::string argument = argv[index];
+        auto nextValue = [&]() -> std::string
         {
-            availableSymbols.insert(symbol);
-            for (int column = 0; column < order; ++column)
+            if (index + 1 >= argc)
             {
-                availableInColumns[column].insert(symbol);
+                throw std::invalid_argument("Не указано значение параметра " + argument);
             }
+            return argv[++index];
+        };
+        if (argument == "--min-order")
+        {
+            options.minimumOrder = static_cast<int>(
+                parseIntegerOption(argument, nextValue(), 1, std::numeric_limits<int>::max()));
         }
-    }
-
-    // Генерирует таблицу Кэли, заполняя строки с помощью метода графа замен.
-    // Возвращает: Полностью сформированную таблицу Кэли.
-    std::vector<std::vector<int>> generate()
-    {
-        for (int row = 0; row < order; ++row)
+        else if (argument == "--max-order")
         {
-            cayleyTable[row] = generateRow();
+            options.maximumOrder = static_cast<int>(
+                parseIntegerOption(argument, nextValue(), 1, std::numeric_limits<int>::max()));
         }
-        return cayleyTable;
-    }
-
-private:
-    // Создает снимок текущих доступных символов в столбцах для использования в графе замен.
-    // Возвращает: Вектор векторов, представляющий доступные символы для каждого столбца.
-    std::vector<std::vector<int>> snapshotColumns() const
-    {
-        std::vector<std::vector<int>> snapshot(order);
-        for (int column = 0; column < order; ++column)
+        else if (argument == "--corpus")
         {
-            snapshot[column].assign(availableInColumns[column].begin(), availableInColumns[column].end());
+            options.corpusSize = static_cast<int>(
+                parseIntegerOption(argument, nextValue(), 1, std::numeric_limits<int>::max()));
         }
-        return snapshot;
-    }
-
-    // Генерирует одну строку таблицы Кэли, выбирая символы, чтобы сохранить свойства латинского квадрата.
-    // Возвращает: Вектор, представляющий строку таблицы.
-    std::vector<int> generateRow()
-    {
-        std::unordered_set<int> availableInRow = availableSymbols;
-        std::vector<std::unordered_set<int>> initialAvailable = availableInColumns;
-        std::vector<int> row;
-        row.reserve(order);
-        int currentColumn = 0;
-        while (currentColumn < order)
+        else if (argument == "--min-time")
         {
-            std::unordered_set<int> available = availableInColumns[currentColumn];
-            std::unordered_set<int> validSymbols;
-            for (int symbol : available)
-            {
-                if (availableInRow.count(symbol))
-                {
-                    validSymbols.insert(symbol);
-                }
-            }
-            if (!validSymbols.empty())
-            {
-                int selectedSymbol = selectRandomElement(validSymbols);
-                availableInColumns[currentColumn].erase(selectedSymbol);
-                availableInRow.erase(selectedSymbol);
-                row.push_back(selectedSymbol);
-                ++currentColumn;
-            }
-            else
-            {
-                auto replacementGraph = constructReplacementGraph(row, currentColumn, initialAvailable);
-                int selectedElement = selectRandomElement(availableInColumns[currentColumn]);
-                makeElementAvailable(selectedElement, replacementGraph, row, currentColumn, availableInRow);
-            }
+            options.minimumSeconds = parseIntegerOption(argument, nextValue(), 0) / 1000.0;
+        }
+        else if (argument == "--seed")
+        {
+            options.seed = static_cast<std::uint32_t>(
+                parseIntegerOption(argument, nextValue(), 0, std::numeric_limits<std::uint32_t>::max()));
+        }
+        else if (argument == "--threads")
+        {
+            options.threadCount = static_cast<unsigned>(
+                parseIntegerOption(argument, nextValue(), 1, std::numeric_limits<unsigned>::max()));
+        }
+        else
+        {
+            throw std::invalid_argument("Неизвестный параметр " + argument);
         }
-        return row;
     }
+    if (options.minimumOrder > options.maximumOrder)
+    {
+        throw std::invalid_argument("--min-order больше --max-order");
+    }
+    return options;
+}
 
-    // Тип данных для представления графа замен, используемого при генерации строки.
-    using ReplacementGraph = std::unordered_map<int, std::unordered_set<int>>;
+// Замеряет операцию: повторяет ее, пока не пройдет minimumSeconds и не выполнится minimumOperations раз,
+// и выводит строку "name order ops ns/op allocs/op bytes/op peak_rss_kib".
+// Параметры:
+//   name: Имя замера.
+//   order: Порядок таблиц.
+//   minimumSeconds: Минимальное время замера.
+//   minimumOperations: Минимальное число повторов.
+//   operation: Вызывается с номером повтора и возвращает значение, от которого зависит результат
+//              (защищает вызов от удаления оптимизатором).
+template <class Operation>
+void runBenchmark(const std::string &name, int order, double minimumSeconds, long long minimumOperations,
+                  Operation &&operation)
+{
+    static volatile long long benchmarkSink = 0;
+    unsigned long long allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+    unsigned long long bytesBefore = allocatedBytes.load(std::memory_order_relaxed);
+    auto startTime = std::chrono::steady_clock::now();
+    long long operationCount = 0;
+    double elapsedSeconds = 0;
+    long long sink = 0;
+    do
+    {
+        sink += static_cast<long long>(operation(operationCount));
+        ++operationCount;
+        elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    } while (elapsedSeconds < minimumSeconds || operationCount < minimumOperations);
+    benchmarkSink = benchmarkSink + sink;
+    double operations = static_cast<double>(operationCount);
+    std::cout << name << ' ' << order << ' ' << operationCount << ' '
+              << static_cast<long long>(elapsedSeconds * 1e9 / operations) << ' ';
+    if (QUASIGROUP_TRACK_ALLOCATIONS)
+    {
+        std::cout << (allocationCount.load(std::memory_order_relaxed) - allocationsBefore) / operations << ' '
+                  << static_cast<long long>((allocatedBytes.load(std::memory_order_relaxed) - bytesBefore) / operations);
+    }
+    else
+    {
+        std::cout << "- -";
+    }
+    std::cout << ' ' << getPeakResidentSetKibibytes() << std::endl;
+}
 
-    // Строит граф замен для текущей строки и столбца.
-    // Параметры:
-    //   row: Текущая частично заполненная строка.
-    //   currentColumn: Текущий столбец для заполнения.
-    //   initialAvailable: Начальные доступные символы для столбцов.
-    // Возвращает: Граф замен, где ключи — индексы столбцов, значения — доступные символы.
-    ReplacementGraph constructReplacementGraph(const std::vector<int> &row, int currentColumn,
-                                               const std::vector<std::unordered_set<int>> &initialAvailable)
+// Замеряет e-преобразование на 1 МиБ данных (ns/op — на мегабайт): encode и decode одного потока с одним
+// и с тремя раундами и encode восьми дорожек по 128 КиБ.
+// Параметры:
+//   generatorName: Имя генератора таблицы.
+//   table: Таблица порядка не больше 256.
+//   minimumSeconds: Минимальное время замера.
+void runStringTransformationBenchmarks(const std::string &generatorName, CayleyTableView table, double minimumSeconds)
+{
+    QuasigroupStringTransformer transformer{Quasigroup(table)};
+    int order = table.getOrder();
+    std::size_t length = 1 << 20, laneLength = length / QuasigroupStringTransformer::laneCount;
+    std::vector<std::uint8_t> data(length);
+    for (std::size_t index = 0; index < length; ++index)
     {
-        ReplacementGraph graph;
-        for (int column = currentColumn; column >= 0; --column)
-        {
-            if (!initialAvailable[column].empty())
-            {
-                graph[column] = initialAvailable[column];
-            }
-        }
-        return graph;
+        data[index] = static_cast<std::uint8_t>(getRandomNumberGenerator()() % order);
+    }
+    std::vector<const std::uint8_t *> inputs;
+    std::vector<std::uint8_t *> outputs;
+    for (std::size_t lane = 0; lane < QuasigroupStringTransformer::laneCount; ++lane)
+    {
+        inputs.push_back(data.data() + lane * laneLength);
+        outputs.push_back(data.data() + lane * laneLength);
+    }
+    std::uint8_t leader = static_cast<std::uint8_t>(order - 1);
+    for (std::size_t roundCount : {1, 3})
+    {
+        std::string suffix = ":" + generatorName + (roundCount == 1 ? "" : "x3");
+        std::vector<std::uint8_t> state(roundCount, leader);
+        runBenchmark("encode" + suffix, order, minimumSeconds, 1, [&](long long)
+                     {
+                         transformer.encode(state, data.data(), data.data(), length);
+                         return data.back(); });
+        runBenchmark("decode" + suffix, order, minimumSeconds, 1, [&](long long)
+                     {
+                         transformer.decode(state, data.data(), data.data(), length);
+                         return data.back(); });
+        std::vector<std::uint8_t> states(roundCount * QuasigroupStringTransformer::laneCount, leader);
+        runBenchmark("encode-lanes" + suffix, order, minimumSeconds, 1, [&](long long)
+                     {
+                         transformer.encodeStreams(states, inputs.data(), outputs.data(), inputs.size(), laneLength);
+                         return data.back(); });
     }
+}
 
-    // Делает элемент доступным в текущем столбце, обновляя строку и граф замен.
-    // Параметры:
-    //   oldElement: Элемент, который нужно сделать доступным.
-    //   graph: Граф замен для текущей строки.
-    //   row: Текущая строка.
-    //   currentColumn: Текущий столбец.
-    //   availableInRow: Доступные символы для строки.
-    void makeElementAvailable(int oldElement, ReplacementGraph &graph, std::vector<int> &row,
-                              int currentColumn, std::unordered_set<int> &availableInRow)
+// Выполняет режим --benchmark: для каждого порядка строит корпус с фиксированным зерном (циклическая группа,
+// corpusSize аффинных и corpusSize таблиц srg) и замеряет генераторы, isLatinSquare и обе проверки
+// hasSubquasigroups на таблицах корпуса каждого генератора. Проверки подквазигрупп создают новую Quasigroup
+// на каждый повтор, чтобы не замерять кэшированный результат; таблица корпуса при этом не копируется,
+// а заимствуется через CayleyTableView.
+// Параметр options: Параметры замеров.
+// Возвращает: Код завершения программы.
+int runBenchmarks(const BenchmarkOptions &options)
+{
+    std::cout << "# compiler " <<
+#if defined(__VERSION__)
+        __VERSION__
+#else
+        "unknown"
+#endif
+              << "\n# optimize "
+#if defined(__OPTIMIZE__)
+              << "on"
+#else
+              << "off"
+#endif
+              << ", bmi2 "
+#if defined(__BMI2__)
+              << "on"
+#else
+              << "off"
+#endif
+              << ", track-allocations " << (QUASIGROUP_TRACK_ALLOCATIONS ? "on" : "off")
+              << ", threads " << options.threadCount << ", seed " << options.seed << "\n"
+              << "# benchmark order ops ns/op allocs/op bytes/op peak_rss_kib" << std::endl;
+    WorkStealingThreadPool threadPool(options.threadCount);
+    for (long long order = options.minimumOrder; order <= options.maximumOrder; order *= 2)
     {
-        int initialElement = oldElement;
-        eraseInitialElementFromGraph(graph, initialElement);
-        int oldIndex = std::find(row.begin(), row.end(), oldElement) - row.begin();
-        int newIndex;
-        std::unordered_set<int> visitedPath;
-        while (true)
+        int tableOrder = static_cast<int>(order);
+        getRandomNumberGenerator().seed(options.seed + static_cast<std::uint32_t>(tableOrder));
+        std::vector<std::pair<std::string, std::vector<CayleyTable>>> corpus;
+        corpus.push_back({"cyclic", {generateCyclicGroupCayleyTable(tableOrder)}});
+
+        std::vector<CayleyTable> affineTables;
+        std::vector<int> permutationFunction = generateRandomPermutation(tableOrder);
+        int coefficientAlpha = selectRandomCoprimeCoefficient(tableOrder);
+        int coefficientBeta = selectRandomCoprimeCoefficient(tableOrder);
+        runBenchmark("generate:affine", tableOrder, options.minimumSeconds, options.corpusSize,
+                     [&](long long operationIndex)
+                     {
+                         CayleyTable table = generateAffineQuasigroupCayleyTable(
+                             tableOrder, coefficientAlpha, coefficientBeta,
+                             static_cast<int>(operationIndex % tableOrder), permutationFunction);
+                         int corner = table(tableOrder - 1, tableOrder - 1);
+                         if (operationIndex < options.corpusSize)
+                         {
+                             affineTables.push_back(std::move(table));
+                         }
+                         return corner;
+                     });
+        corpus.push_back({"affine", std::move(affineTables)});
+
+        std::vector<CayleyTable> replacementGraphTables;
+        runBenchmark("generate:srg", tableOrder, options.minimumSeconds, options.corpusSize,
+                     [&](long long operationIndex)
+                     {
+                         CayleyTable table = generateSequentialReplacementGraphCayleyTable(tableOrder);
+                         int corner = table(tableOrder - 1, tableOrder - 1);
+                         if (operationIndex < options.corpusSize)
+                         {
+                             replacementGraphTables.push_back(std::move(table));
+                         }
+                         return corner;
+                     });
+        corpus.push_back({"srg", std::move(replacementGraphTables)});
+
+        // Одна таблица jm — N шагов цепи, как в --generate jm по умолчанию.
+        JacobsonMatthewsSampler sampler(generateCyclicGroupCayleyTable(tableOrder));
+        sampler.advance(order);
+        CayleyTable sampledTable(tableOrder);
+        runBenchmark("generate:jm", tableOrder, options.minimumSeconds, 0,
+                     [&](long long)
+                     {
+                         sampler.advance(order);
+                         sampler.copyTo(sampledTable);
+                         return sampledTable(tableOrder - 1, tableOrder - 1);
+                     });
+
+        for (const auto &[generatorName, tables] : corpus)
         {
-            auto &choices = graph[oldIndex];
-            std::unordered_set<int> availableChoices = choices;
-            for (int pathElement : visitedPath)
-            {
-                availableChoices.erase(pathElement);
-            }
-            if (availableChoices.empty())
+            auto tableAt = [&](long long operationIndex) -> const CayleyTable &
             {
-                visitedPath.clear();
-                availableChoices = choices;
-            }
-            int newElement = selectRandomElement(availableChoices);
-            newIndex = std::find(row.begin(), row.end(), newElement) - row.begin();
-            row[oldIndex] = newElement;
-            visitedPath.insert(newElement);
-            if (std::find(row.begin(), row.end(), oldElement) == row.end())
-            {
-                availableInRow.insert(oldElement);
-            }
-            availableInRow.erase(newElement);
-            availableInColumns[oldIndex].insert(oldElement);
-            availableInColumns[oldIndex].erase(newElement);
-            if (availableInRow.count(initialElement) && (newIndex >= static_cast<int>(row.size())))
+                return tables[static_cast<std::size_t>(operationIndex) % tables.size()];
+            };
+            long long corpusCount = static_cast<long long>(tables.size());
+            runBenchmark("latin:" + generatorName, tableOrder, options.minimumSeconds, corpusCount,
+                         [&](long long operationIndex)
+                         { return isLatinSquare(tableAt(operationIndex)); });
+            runBenchmark("proper:" + generatorName, tableOrder, options.minimumSeconds, corpusCount,
+                         [&](long long operationIndex)
+                         { return Quasigroup(tableAt(operationIndex)).hasSubquasigroups(true, threadPool); });
+            runBenchmark("nontrivial:" + generatorName, tableOrder, options.minimumSeconds, corpusCount,
+                         [&](long long operationIndex)
+                         { return Quasigroup(tableAt(operationIndex)).hasSubquasigroups(false, threadPool); });
+            if (tableOrder <= maximumFixedQuasigroupOrder)
             {
-                break;
+                visitFixedOrder(tableOrder, [&](auto fixedOrder)
+                                {
+                                    using FixedQuasigroup = FixedOrderQuasigroup<decltype(fixedOrder)::value>;
+                                    std::vector<FixedQuasigroup> fixedTables;
+                                    for (const CayleyTable &table : tables)
+                                    {
+                                        fixedTables.push_back(FixedQuasigroup::fromCayleyTable(table));
+                                    }
+                                    runBenchmark("fixed:" + generatorName, tableOrder, options.minimumSeconds, corpusCount,
+                                                 [&](long long operationIndex)
+                                                 {
+                                                     const FixedQuasigroup &quasigroup =
+                                                         fixedTables[static_cast<std::size_t>(operationIndex) % fixedTables.size()];
+                                                     return quasigroup.hasSubquasigroups(true) + 2 * quasigroup.hasSubquasigroups(false);
+                                                 }); });
             }
-            if (newIndex >= static_cast<int>(row.size()))
+            // Локальный поиск: обмен двух строк и новый вердикт по запомненным замыканиям.
+            IncrementalSubquasigroupAnalyzer incrementalAnalyzer(tables.front());
+            incrementalAnalyzer.hasProperSubquasigroups();
+            runBenchmark("incremental:" + generatorName, tableOrder, options.minimumSeconds, corpusCount,
+                         [&](long long operationIndex)
+                         {
+                             incrementalAnalyzer.swapRows(static_cast<int>(operationIndex % tableOrder),
+                                                          static_cast<int>((operationIndex * 7 + 1) % tableOrder));
+                             return incrementalAnalyzer.hasProperSubquasigroups();
+                         });
+            if (tableOrder <= QuasigroupStringTransformer::maximumOrder)
             {
-                break;
+                runStringTransformationBenchmarks(generatorName, tables.front(), options.minimumSeconds);
             }
-            oldIndex = newIndex;
-            oldElement = newElement;
         }
     }
+    return 0;
+}
 
-    // Удаляет начальный элемент из графа замен, чтобы избежать его повторного использования.
-    // Параметры:
-    //   graph: Граф замен.
-    //   initialElement: Элемент для удаления.
-    static void eraseInitialElementFromGraph(ReplacementGraph &graph, int initialElement)
-    {
-        for (auto &[column, symbols] : graph)
-        {
-            symbols.erase(initialElement);
-        }
-    }
+// Параметры режима --enumerate.
+struct EnumerationOptions
+{
+    int order = 0;                    // Порядок квадратов (обязателен).
+    std::string checkName = "proper"; // proper — только без собственных подквазигрупп, none — все квадраты.
+    unsigned threadCount = 1;         // Потоки перебора.
 };
 
-// Создает таблицу Кэли с помощью метода последовательного графа замен.
-// Параметр order: Размер квазигруппы.
-// Возвращает: Вектор векторов, представляющий таблицу Кэли.
-std::vector<std::vector<int>> generateSequentialReplacementGraphCayleyTable(int order)
+// Выводит справку по параметрам режима --enumerate.
+// Параметр stream: Поток вывода.
+void printEnumerationUsage(std::ostream &stream)
 {
-    SequentialReplacementGraphGenerator generator(order);
-    return generator.generate();
+    stream << "Полный перебор (--enumerate):\n"
+           << "  --order N            Порядок латинских квадратов (от 1 до " << maximumEnumerationOrder << ")\n"
+           << "  --check proper|none  Считать квадраты без собственных подквазигрупп или все (по умолчанию proper)\n"
+           << "  --threads T          Потоки перебора (по умолчанию 1)\n";
 }
 
-// Проверяет, является ли таблица латинским квадратом.
-// Проверяет, что каждый элемент встречается ровно один раз в каждой строке и столбце.
-// Параметр table: Таблица для проверки.
-// Возвращает: true, если таблица — латинский квадрат, false — иначе.
-bool isLatinSquare(const std::vector<std::vector<int>> &table)
+// Разбирает параметры режима --enumerate; argv[1] — сам параметр --enumerate.
+// Параметры argc, argv: Аргументы main.
+// Возвращает: Заполненные параметры.
+// Выбрасывает: std::invalid_argument при неизвестном, некорректном или отсутствующем параметре.
+EnumerationOptions parseEnumerationOptions(int argc, char **argv)
 {
-    int order = table.size();
-    for (int row = 0; row < order; ++row)
+    EnumerationOptions options;
+    for (int index = 2; index < argc; ++index)
     {
-        std::vector<bool> rowUsed(order, false), columnUsed(order, false);
-        for (int column = 0; column < order; ++column)
+        std::string argument = argv[index];
+        auto nextValue = [&]() -> std::string
         {
-            int rowValue = table[row][column], columnValue = table[column][row];
-            if (rowValue < 0 || rowValue >= order || columnValue < 0 || columnValue >= order ||
-                rowUsed[rowValue] || columnUsed[columnValue])
+            if (index + 1 >= argc)
             {
-                return false;
+                throw std::invalid_argument("Не указано значение параметра " + argument);
             }
-            rowUsed[rowValue] = columnUsed[columnValue] = true;
+            return argv[++index];
+        };
+        if (argument == "--order")
+        {
+            options.order = static_cast<int>(
+                parseIntegerOption(argument, nextValue(), 1, std::numeric_limits<int>::max()));
+        }
+        else if (argument == "--check")
+        {
+            options.checkName = nextValue();
+        }
+        else if (argument == "--threads")
+        {
+            options.threadCount = static_cast<unsigned>(
+                parseIntegerOption(argument, nextValue(), 1, std::numeric_limits<unsigned>::max()));
+        }
+        else
+        {
+            throw std::invalid_argument("Неизвестный параметр " + argument);
         }
     }
-    return true;
-}
-
-// Выводит таблицу Кэли в консоль в читаемом формате.
-// Параметр table: Таблица Кэли для вывода.
-// Форматирует таблицу с заголовками строк и столбцов.
-void printCayleyTable(const std::vector<std::vector<int>> &table)
-{
-    int order = table.size();
-    std::cout << "\n  | ";
-    for (int column = 0; column < order; ++column)
+    if (options.order == 0)
     {
-        std::cout << column << ' ';
+        throw std::invalid_argument("Не указан --order");
     }
-    std::cout << "\n--+-";
-    for (int column = 0; column < order; ++column)
+    if (options.order > maximumEnumerationOrder)
     {
-        std::cout << "--";
+        throw std::invalid_argument("Порядок перебора должен быть от 1 до " + std::to_string(maximumEnumerationOrder));
     }
-    std::cout << "\n";
-    for (int row = 0; row < order; ++row)
+    if (options.checkName != "proper" && options.checkName != "none")
     {
-        std::cout << row << " | ";
-        for (int column = 0; column < order; ++column)
-        {
-            std::cout << table[row][column] << ' ';
-        }
-        std::cout << "\n";
+        throw std::invalid_argument("Некорректное значение --check: " + options.checkName);
     }
+    return options;
 }
 
-// Сохраняет таблицу Кэли и результаты проверки подквазигрупп в файл.
+// Выполняет режим --enumerate и выводит число квадратов, классы первых строк, число задач и время.
+// Параметр options: Параметры перебора.
+// Возвращает: Код завершения программы.
+int runEnumeration(const EnumerationOptions &options)
+{
+    auto startTime = std::chrono::steady_clock::now();
+    WorkStealingThreadPool threadPool(options.threadCount);
+    bool countsAllSquares = options.checkName == "none";
+    LatinSquareEnumeration enumeration = enumerateLatinSquares(options.order, countsAllSquares, threadPool);
+    double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    std::cout << "Порядок: " << options.order << "\n"
+              << (countsAllSquares ? "Латинских квадратов: " : "Латинских квадратов без собственных подквазигрупп: ")
+              << formatEnumerationCount(enumeration.squareCount) << "\n"
+              << "Классов первой строки: " << enumeration.firstRowClassCount << ", задач: " << enumeration.taskCount << "\n"
+              << "Время: " << elapsedSeconds << " с\n";
+    return 0;
+}
+
+// Выполняет режимы --encode и --decode: файл преобразуется частями по 1 МиБ, состояние раундов
+// переносится между частями, так что размер файла не ограничен памятью.
 // Параметры:
-//   table: Таблица Кэли.
-//   quasigroup: Квазигруппа для проверки подквазигрупп.
-//   fileName: Имя файла для записи.
-// Записывает порядок, таблицу и результаты проверки.
-void writeResultsToFile(const std::vector<std::vector<int>> &table, const Quasigroup &quasigroup,
-                        const std::string &fileName)
+//   isDecoding: true для --decode.
+//   tableFileName: Файл таблицы Кэли (порядок не больше 256).
+//   leadersText: Лидеры раундов через запятую, например "3,7,1".
+//   inputFileName, outputFileName: Входной и выходной файлы.
+// Выбрасывает: std::runtime_error при ошибке ввода-вывода, std::invalid_argument при некорректных лидерах или байтах.
+void runStringTransformation(bool isDecoding, const std::string &tableFileName, const std::string &leadersText,
+                             const std::string &inputFileName, const std::string &outputFileName)
 {
-    std::ofstream file(fileName);
-    if (!file)
-    {
-        throw std::runtime_error("Не удалось открыть файл для записи");
-    }
-    int order = table.size();
-    file << order << "\n";
-    for (const auto &row : table)
+    QuasigroupStringTransformer transformer(Quasigroup(readCayleyTableFromFile(tableFileName)));
+    std::vector<std::uint8_t> state;
+    std::size_t position = 0;
+    while (position <= leadersText.size())
     {
-        for (int value : row)
+        std::size_t separator = std::min(leadersText.find(',', position), leadersText.size());
+        long long leader = parseIntegerOption("лидера", leadersText.substr(position, separator - position), 0);
+        if (leader >= transformer.getOrder())
         {
-            file << value << ' ';
+            throw std::invalid_argument("Лидер " + std::to_string(leader) + " не является элементом квазигруппы");
         }
-        file << "\n";
+        state.push_back(static_cast<std::uint8_t>(leader));
+        position = separator + 1;
     }
-    bool hasProperSubquasigroups = quasigroup.hasSubquasigroups(true);
-    bool hasNonTrivialSubquasigroups = quasigroup.hasSubquasigroups(false);
-    file << "\nРезультаты проверки:\n";
-    file << "- Собственные подквазигруппы: " << (hasProperSubquasigroups ? "присутствуют" : "отсутствуют") << "\n";
-    file << "- Нетривиальные подквазигруппы: " << (hasNonTrivialSubquasigroups ? "присутствуют" : "отсутствуют") << "\n";
-    if (hasProperSubquasigroups && hasNonTrivialSubquasigroups)
+    std::ifstream input(inputFileName, std::ios::binary);
+    if (!input)
     {
-        file << "Квазигруппа содержит собственные нетривиальные подквазигруппы.\n";
+        throw std::runtime_error("Не удалось открыть файл " + inputFileName);
     }
-    else
+    std::ofstream output(outputFileName, std::ios::binary);
+    if (!output)
     {
-        file << "Квазигруппа не содержит одновременно собственных и нетривиальных подквазигрупп.\n";
+        throw std::runtime_error("Не удалось создать файл " + outputFileName);
+    }
+    std::vector<std::uint8_t> buffer(1 << 20);
+    while (input)
+    {
+        input.read(reinterpret_cast<char *>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+        std::size_t length = static_cast<std::size_t>(input.gcount());
+        if (isDecoding)
+        {
+            transformer.decode(state, buffer.data(), buffer.data(), length);
+        }
+        else
+        {
+            transformer.encode(state, buffer.data(), buffer.data(), length);
+        }
+        output.write(reinterpret_cast<const char *>(buffer.data()), static_cast<std::streamsize>(length));
+    }
+    if (input.bad() || !output)
+    {
+        throw std::runtime_error("Ошибка ввода-вывода при преобразовании " + inputFileName);
     }
-    std::cout << "Результаты сохранены в " << fileName << "\n";
 }
 
 // Основная функция программы, предоставляет интерактивный интерфейс для работы с квазигруппами.
 // Позволяет пользователю выбирать способы ввода таблицы Кэли, выполнять проверки подквазигрупп и сохранять результаты.
 // Управляет основным циклом программы с обработкой ошибок.
-int main()
+// С параметрами командной строки выполняет пакетный режим (см. printBatchUsage), замеры (--benchmark) или полный
+// перебор (--enumerate) вместо меню.
+int main(int argc, char **argv)
 {
+    if (argc > 1)
+    {
+        if (std::string(argv[1]) == "--help")
+        {
+            printBatchUsage(std::cout);
+            printBenchmarkUsage(std::cout);
+            printEnumerationUsage(std::cout);
+            return 0;
+        }
+        if (std::string(argv[1]) == "--encode" || std::string(argv[1]) == "--decode")
+        {
+            if (argc != 6)
+            {
+                std::cerr << "Использование: " << argv[1] << " ТАБЛИЦА ЛИДЕРЫ ВХОДНОЙ_ФАЙЛ ВЫХОДНОЙ_ФАЙЛ\n"
+                          << "  ЛИДЕРЫ — элементы через запятую, по одному на раунд (например 3,7,1)\n";
+                return 1;
+            }
+            try
+            {
+                runStringTransformation(std::string(argv[1]) == "--decode", argv[2], argv[3], argv[4], argv[5]);
+                return 0;
+            }
+            catch (const std::exception &error)
+            {
+                std::cerr << "Ошибка: " << error.what() << "\n";
+                return 1;
+            }
+        }
+        if (std::string(argv[1]) == "--convert")
+        {
+            if (argc != 4)
+            {
+                std::cerr << "Использование: --convert ВХОДНОЙ_ФАЙЛ ВЫХОДНОЙ_ФАЙЛ\n";
+                return 1;
+            }
+            try
+            {
+                writeCayleyTableToFile(readCayleyTableFromFile(argv[2]), argv[3]);
+                return 0;
+            }
+            catch (const std::exception &error)
+            {
+                std::cerr << "Ошибка: " << error.what() << "\n";
+                return 1;
+            }
+        }
+        // Справка выводится только при ошибке разбора параметров; ошибки выполнения (файлы, шарды другого
+        // запуска, поврежденный корпус) сообщаются одной строкой.
+        bool isEnumeration = std::string(argv[1]) == "--enumerate";
+        bool isBenchmark = std::string(argv[1]) == "--benchmark";
+        std::function<int()> runMode;
+        try
+        {
+            if (isEnumeration)
+            {
+                runMode = [options = parseEnumerationOptions(argc, argv)] { return runEnumeration(options); };
+            }
+            else if (isBenchmark)
+            {
+                runMode = [options = parseBenchmarkOptions(argc, argv)] { return runBenchmarks(options); };
+            }
+            else
+            {
+                runMode = [options = parseBatchOptions(argc, argv)] { return runBatch(options); };
+            }
+        }
+        catch (const std::exception &error)
+        {
+            std::cerr << "Ошибка: " << error.what() << "\n";
+            if (isEnumeration)
+            {
+                printEnumerationUsage(std::cerr);
+            }
+            else if (isBenchmark)
+            {
+                printBenchmarkUsage(std::cerr);
+            }
+            else
+            {
+                printBatchUsage(std::cerr);
+            }
+            return 1;
+        }
+        try
+        {
+            return runMode();
+        }
+        catch (const std::exception &error)
+        {
+            std::cerr << "Ошибка: " << error.what() << "\n";
+            return 1;
+        }
+    }
+
+    WorkStealingThreadPool threadPool;
     bool exitProgram = false;
     while (!exitProgram)
     {
@@ -608,7 +6974,7 @@ int main()
         {
             return 0;
         }
-        std::vector<std::vector<int>> cayleyTable;
+        CayleyTable cayleyTable;
         try
         {
             if (choice == 1)
@@ -652,16 +7018,20 @@ int main()
             {
                 continue;
             }
+            // Прочитанные таблицы проверяются при чтении, сгенерированные — здесь.
+            if (choice >= 3)
+            {
+                validateLatinSquare(cayleyTable);
+            }
         }
         catch (const std::exception &error)
         {
             std::cerr << "Ошибка: " << error.what() << "\n";
             continue;
         }
-        Quasigroup quasigroup(cayleyTable);
-        printCayleyTable(cayleyTable);
+        Quasigroup quasigroup(std::move(cayleyTable));
+        printCayleyTable(quasigroup.getCayleyTable());
         bool returnToMainMenu = false;
-        bool hasProperSubquasigroups = false, hasNonTrivialSubquasigroups = false;
         std::string outputFileName;
         while (!returnToMainMenu && !exitProgram)
         {
@@ -672,31 +7042,54 @@ int main()
                       << "4 - Сохранение результатов в файл\n"
                       << "5 - Вернуться в главное меню\n"
                       << "6 - Выход\n"
+                      << "7 - Решётка подквазигрупп\n"
+                      << "8 - Сохранение таблицы в файл (.qgb — двоичный формат)\n"
                       << "Выбор: ";
             int action;
             std::cin >> action;
             switch (action)
             {
             case 1:
-                hasProperSubquasigroups = quasigroup.hasSubquasigroups(true);
-                std::cout << (hasProperSubquasigroups ? "Обнаружена собственная подквазигруппа\n"
-                                                      : "Собственные подквазигруппы отсутствуют\n");
+                std::cout << (quasigroup.analyzeSubquasigroups(threadPool).hasProperSubquasigroups
+                                  ? "Обнаружена собственная подквазигруппа\n"
+                                  : "Собственные подквазигруппы отсутствуют\n");
                 break;
             case 2:
-                hasNonTrivialSubquasigroups = quasigroup.hasSubquasigroups(false);
-                std::cout << (hasNonTrivialSubquasigroups ? "Обнаружена нетривиальная подквазигруппа\n"
-                                                          : "Нетривиальные подквазигруппы отсутствуют\n");
+                std::cout << (quasigroup.analyzeSubquasigroups(threadPool).hasNonTrivialSubquasigroups
+                                  ? "Обнаружена нетривиальная подквазигруппа\n"
+                                  : "Нетривиальные подквазигруппы отсутствуют\n");
                 break;
             case 3:
-                hasProperSubquasigroups = quasigroup.hasSubquasigroups(true);
-                hasNonTrivialSubquasigroups = quasigroup.hasSubquasigroups(false);
-                std::cout << "Собственная подквазигруппа: " << (hasProperSubquasigroups ? "есть\n" : "нет\n")
-                          << "Нетривиальная подквазигруппа: " << (hasNonTrivialSubquasigroups ? "есть\n" : "нет\n");
+            {
+                const SubquasigroupAnalysis &analysis = quasigroup.analyzeSubquasigroups(threadPool);
+                std::cout << "Собственная подквазигруппа: ";
+                if (analysis.hasProperSubquasigroups)
+                {
+                    std::cout << "есть ";
+                    printElementSet(std::cout, analysis.properWitness);
+                    std::cout << "\n";
+                }
+                else
+                {
+                    std::cout << "нет\n";
+                }
+                std::cout << "Нетривиальная подквазигруппа: ";
+                if (analysis.hasNonTrivialSubquasigroups)
+                {
+                    std::cout << "есть ";
+                    printElementSet(std::cout, analysis.nonTrivialWitness);
+                    std::cout << "\n";
+                }
+                else
+                {
+                    std::cout << "нет\n";
+                }
                 break;
+            }
             case 4:
                 std::cout << "Введите имя файла для записи: ";
                 std::cin >> outputFileName;
-                writeResultsToFile(cayleyTable, quasigroup, outputFileName);
+                writeResultsToFile(quasigroup, outputFileName);
                 break;
             case 5:
                 returnToMainMenu = true;
@@ -704,6 +7097,22 @@ int main()
             case 6:
                 exitProgram = true;
                 break;
+            case 7:
+                printSubquasigroupLattice(quasigroup.enumerateSubquasigroupLattice());
+                break;
+            case 8:
+                std::cout << "Введите имя файла для записи: ";
+                std::cin >> outputFileName;
+                try
+                {
+                    writeCayleyTableToFile(quasigroup.getCayleyTable(), outputFileName);
+                    std::cout << "Таблица сохранена в " << outputFileName << "\n";
+                }
+                catch (const std::exception &error)
+                {
+                    std::cerr << "Ошибка: " << error.what() << "\n";
+                }
+                break;
             default:
                 break;
             }